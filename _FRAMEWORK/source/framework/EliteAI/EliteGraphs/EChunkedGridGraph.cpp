@@ -0,0 +1,268 @@
+#include "stdafx.h"
+#include "EChunkedGridGraph.h"
+#include "EGraphFileFormat.h"
+#include "framework\EliteHelpers\EMemoryMappedFile.h"
+
+using namespace Elite;
+
+Elite::ChunkedGridGraph::ChunkedGridGraph(const std::string& tileDirectory, int columns, int rows, int tileSize, int cellSize,
+	bool isConnectedDiagonally, float costStraight, float costDiagonal, size_t maxLoadedTiles) :
+	m_TileDirectory(tileDirectory),
+	m_NrOfColumns(columns),
+	m_NrOfRows(rows),
+	m_TileSize(tileSize),
+	m_NrOfTileColumns((columns + tileSize - 1) / tileSize),
+	m_CellSize(cellSize),
+	m_IsConnectedDiagonally(isConnectedDiagonally),
+	m_DefaultCostStraight(costStraight),
+	m_DefaultCostDiagonal(costDiagonal),
+	m_MaxLoadedTiles(maxLoadedTiles)
+{
+	assert(tileSize > 0 && "<ChunkedGridGraph::ChunkedGridGraph>: tile size has to be positive");
+	assert(maxLoadedTiles > 0 && "<ChunkedGridGraph::ChunkedGridGraph>: at least one tile has to fit in memory");
+}
+
+Elite::ChunkedGridGraph::~ChunkedGridGraph()
+{
+	Flush();
+}
+
+TerrainType Elite::ChunkedGridGraph::GetTerrainType(int col, int row)
+{
+	return ByteToTerrainType(GetTerrainByte(col, row));
+}
+
+bool Elite::ChunkedGridGraph::SetTerrainType(int col, int row, TerrainType terrain)
+{
+	assert(IsWithinBounds(col, row) && "<ChunkedGridGraph::SetTerrainType>: cell out of bounds");
+
+	// Writing into a tile that failed to load would overwrite its file with Water
+	Tile& tile = FetchTile(col / m_TileSize, row / m_TileSize);
+	if (!tile.isLoaded)
+		return false;
+
+	tile.terrain[(row % m_TileSize) * m_TileSize + (col % m_TileSize)] = TerrainTypeToByte(terrain);
+	tile.isDirty = true;
+	return true;
+}
+
+bool Elite::ChunkedGridGraph::IsWalkable(int col, int row)
+{
+	return IsWithinBounds(col, row) && GetTerrainByte(col, row) != TerrainTypeToByte(TerrainType::Water);
+}
+
+bool Elite::ChunkedGridGraph::CanFitAgent(int col, int row, int agentSize)
+{
+	for (int r = row; r < row + agentSize; ++r)
+	{
+		for (int c = col; c < col + agentSize; ++c)
+		{
+			if (!IsWalkable(c, r))
+				return false;
+		}
+	}
+	return true;
+}
+
+Vector2 Elite::ChunkedGridGraph::GetCellWorldPos(int col, int row) const
+{
+	Vector2 cellCenterOffset = { m_CellSize / 2.f, m_CellSize / 2.f };
+	return Vector2{ (float)col * m_CellSize, (float)row * m_CellSize } + cellCenterOffset;
+}
+
+bool Elite::ChunkedGridGraph::GetCellAtWorldPos(const Vector2& pos, int& col, int& row) const
+{
+	if (pos.x < 0 || pos.y < 0)
+		return false;
+
+	col = int(pos.x / m_CellSize);
+	row = int(pos.y / m_CellSize);
+	return IsWithinBounds(col, row);
+}
+
+void Elite::ChunkedGridGraph::GetNeighbors(int col, int row, std::vector<Neighbor>& neighbors)
+{
+	neighbors.clear();
+	ForEachNeighbor(col, row, [&neighbors](int neighborCol, int neighborRow, float cost) { neighbors.push_back({ neighborCol, neighborRow, cost }); });
+}
+
+ChunkedGridGraph::PathResult Elite::ChunkedGridGraph::FindPath(const Vector2& startPos, const Vector2& goalPos, Heuristic hFunction,
+	std::vector<Vector2>& path, int agentSize, int maxExpansions)
+{
+	path.clear();
+	const int nrOfFailedTileLoads = m_NrOfFailedTileLoads;
+
+	int startCol, startRow, goalCol, goalRow;
+	if (!GetCellAtWorldPos(startPos, startCol, startRow) || !GetCellAtWorldPos(goalPos, goalCol, goalRow))
+		return PathResult::NoPath;
+
+	if (!CanFitAgent(startCol, startRow, agentSize) || !CanFitAgent(goalCol, goalRow, agentSize))
+	{
+		const bool isOnFailedTile = !FetchTile(startCol / m_TileSize, startRow / m_TileSize).isLoaded || !FetchTile(goalCol / m_TileSize, goalRow / m_TileSize).isLoaded;
+		return isOnFailedTile || m_NrOfFailedTileLoads != nrOfFailedTileLoads ? PathResult::TileLoadFailed : PathResult::NoPath;
+	}
+
+	// The search state is hashed on the cells it reaches, the terrain it reads stays within the tile budget
+	if (maxExpansions <= 0)
+		maxExpansions = int(std::min(16 * m_MaxLoadedTiles * m_TileSize * m_TileSize, size_t(std::numeric_limits<int>::max())));
+
+	const ChunkedGridGraphView view{ this, agentSize };
+	AStarSearch<ChunkedGridGraphView, float, HashedSearchRecords<float>> search{ &view, hFunction };
+
+	const int goalIdx = view.GetIndex(goalCol, goalRow);
+	search.Start(view.GetIndex(startCol, startRow), goalIdx);
+	const bool isDone = search.Expand(maxExpansions, [goalIdx](int idx) { return idx == goalIdx; });
+
+	for (int idx : search.GetPath())
+	{
+		const Vector2 colRow = view.GetPosition(idx);
+		path.push_back(GetCellWorldPos(int(colRow.x), int(colRow.y)));
+	}
+
+	if (m_NrOfFailedTileLoads != nrOfFailedTileLoads)
+		return PathResult::TileLoadFailed;
+	if (!isDone)
+		return PathResult::ExpansionLimitReached;
+	return path.empty() ? PathResult::NoPath : PathResult::Found;
+}
+
+bool Elite::ChunkedGridGraph::Flush()
+{
+	bool isSaved = true;
+	for (Tile& tile : m_Tiles)
+	{
+		if (!tile.isDirty)
+			continue;
+
+		if (SaveTile(tile))
+			tile.isDirty = false;
+		else
+			isSaved = false;
+	}
+	return isSaved;
+}
+
+uint8_t Elite::ChunkedGridGraph::GetTerrainByte(int col, int row)
+{
+	const int tileCol = col / m_TileSize;
+	const int tileRow = row / m_TileSize;
+
+	// Most lookups hit the tile that was used last, skip the hash lookup for those
+	const Tile& tile = (!m_Tiles.empty() && m_Tiles.front().tileCol == tileCol && m_Tiles.front().tileRow == tileRow)
+		? m_Tiles.front()
+		: FetchTile(tileCol, tileRow);
+
+	return tile.terrain[(row % m_TileSize) * m_TileSize + (col % m_TileSize)];
+}
+
+Elite::ChunkedGridGraph::Tile& Elite::ChunkedGridGraph::FetchTile(int tileCol, int tileRow)
+{
+	const int key = tileRow * m_NrOfTileColumns + tileCol;
+
+	auto foundIt = m_TileLookup.find(key);
+	if (foundIt != m_TileLookup.end())
+	{
+		// Move to the front of the LRU list, iterators stay valid
+		m_Tiles.splice(m_Tiles.begin(), m_Tiles, foundIt->second);
+		return m_Tiles.front();
+	}
+
+	// When nothing can be evicted the cache grows instead of dropping changes
+	if (m_Tiles.size() >= m_MaxLoadedTiles)
+		EvictLeastRecentlyUsedTile();
+
+	m_Tiles.push_front(Tile{ tileCol, tileRow, {}, false, true });
+	Tile& tile = m_Tiles.front();
+	if (!LoadTile(tile))
+	{
+		// Unreadable tiles block movement, and retry loading once they were evicted
+		tile.terrain.assign(size_t(m_TileSize) * m_TileSize, TerrainTypeToByte(TerrainType::Water));
+		tile.isLoaded = false;
+		++m_NrOfFailedTileLoads;
+	}
+
+	m_TileLookup[key] = m_Tiles.begin();
+	return tile;
+}
+
+bool Elite::ChunkedGridGraph::EvictLeastRecentlyUsedTile()
+{
+	// A modified tile that can't be written stays cached, the next least recently used one goes instead
+	for (auto it = m_Tiles.end(); it != m_Tiles.begin();)
+	{
+		--it;
+		if (it->isDirty && !SaveTile(*it))
+			continue;
+
+		m_TileLookup.erase(it->tileRow * m_NrOfTileColumns + it->tileCol);
+		m_Tiles.erase(it);
+		return true;
+	}
+	return false;
+}
+
+bool Elite::ChunkedGridGraph::LoadTile(Tile& tile) const
+{
+	using namespace GraphFileFormat;
+
+	const std::string tilePath = GetTilePath(tile.tileCol, tile.tileRow);
+	MemoryMappedFile file{ tilePath };
+
+	// A tile that was never saved starts out as Ground, a file that exists but can't be mapped (e.g. empty) is a failure
+	if (!file.IsOpen() && !std::ifstream{ tilePath, std::ios::binary })
+	{
+		tile.terrain.assign(size_t(m_TileSize) * m_TileSize, TerrainTypeToByte(TerrainType::Ground));
+		return true;
+	}
+
+	const GridGraphHeader* pHeader = file.GetAt<GridGraphHeader>(0);
+	if (pHeader == nullptr
+		|| pHeader->magic != GridGraphMagic
+		|| pHeader->version != GridGraphVersion
+		|| pHeader->columns != m_TileSize || pHeader->rows != m_TileSize)
+		return false;
+
+	const size_t nrOfCells = size_t(m_TileSize) * m_TileSize;
+	const uint8_t* pTerrain = file.GetAt<uint8_t>(sizeof(GridGraphHeader), nrOfCells);
+	if (pTerrain == nullptr)
+		return false;
+
+	// Bytes past Water would index outside the terrain types
+	const uint8_t maxTerrainByte = TerrainTypeToByte(TerrainType::Water);
+	if (std::any_of(pTerrain, pTerrain + nrOfCells, [maxTerrainByte](uint8_t terrainByte) { return terrainByte > maxTerrainByte; }))
+		return false;
+
+	tile.terrain.assign(pTerrain, pTerrain + nrOfCells);
+	return true;
+}
+
+bool Elite::ChunkedGridGraph::SaveTile(const Tile& tile) const
+{
+	using namespace GraphFileFormat;
+
+	std::ofstream file{ GetTilePath(tile.tileCol, tile.tileRow), std::ios::binary };
+	if (!file)
+		return false;
+
+	// A tile is a regular grid file without connection overrides, so it can also be opened as a GridGraph
+	GridGraphHeader header{};
+	header.magic = GridGraphMagic;
+	header.version = GridGraphVersion;
+	header.columns = m_TileSize;
+	header.rows = m_TileSize;
+	header.cellSize = m_CellSize;
+	header.flags = m_IsConnectedDiagonally ? GridFlag_ConnectedDiagonally : 0;
+	header.costStraight = m_DefaultCostStraight;
+	header.costDiagonal = m_DefaultCostDiagonal;
+	header.nrOfCostOverrides = 0;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(tile.terrain.data()), tile.terrain.size());
+
+	return file.good();
+}
+
+std::string Elite::ChunkedGridGraph::GetTilePath(int tileCol, int tileRow) const
+{
+	return m_TileDirectory + "/tile_" + std::to_string(tileCol) + "_" + std::to_string(tileRow) + ".egrd";
+}
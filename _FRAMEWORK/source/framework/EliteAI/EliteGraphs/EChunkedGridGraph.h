@@ -0,0 +1,200 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EChunkedGridGraph.h: Terrain grid split into square tiles that are streamed from disk through an LRU cache,
+// so only a bounded number of tiles is in memory no matter how large the world is
+/*=============================================================================*/
+#pragma once
+
+#include "EGridGraph.h"
+#include "EGraphEnums.h"
+#include "EliteGraphAlgorithms/EAStar.h"
+
+namespace Elite
+{
+	class ChunkedGridGraph final
+	{
+	public:
+		// Tiles are read from and written to tileDirectory, tiles without a file start out as Ground
+		// A tile whose file can't be read is treated as Water and isn't written back, see GetNrOfFailedTileLoads
+		ChunkedGridGraph(const std::string& tileDirectory, int columns, int rows, int tileSize, int cellSize,
+			bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f, size_t maxLoadedTiles = 64);
+		~ChunkedGridGraph();
+
+		int GetRows() const { return m_NrOfRows; }
+		int GetColumns() const { return m_NrOfColumns; }
+		int GetTileSize() const { return m_TileSize; }
+		int GetCellSize() const { return m_CellSize; }
+
+		bool IsWithinBounds(int col, int row) const { return col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows; }
+
+		// Cell access, loads the owning tile if it isn't cached yet
+		TerrainType GetTerrainType(int col, int row);
+		// Returns false if the cell's tile couldn't be loaded, the cell is left unchanged then
+		bool SetTerrainType(int col, int row, TerrainType terrain);
+		bool IsWalkable(int col, int row);
+		// The agentSize x agentSize square with (col, row) as its top-left corner is walkable
+		bool CanFitAgent(int col, int row, int agentSize);
+
+		Vector2 GetCellWorldPos(int col, int row) const;
+		bool GetCellAtWorldPos(const Vector2& pos, int& col, int& row) const;
+
+		// Reachable neighbors of a cell and the cost to get there, tile borders are crossed transparently
+		struct Neighbor
+		{
+			int col;
+			int row;
+			float cost;
+		};
+		void GetNeighbors(int col, int row, std::vector<Neighbor>& neighbors);
+		// Calls visit(neighborCol, neighborRow, cost) for each reachable neighbor
+		template<class T_Visit>
+		void ForEachNeighbor(int col, int row, T_Visit&& visit);
+
+		// Copies a rectangle of the world into a regular GridGraph (cell (originCol, originRow) becomes cell (0, 0))
+		// so the GridGraph pathfinders (e.g. JPS) can run on a part of the world the caller picks
+		template<class T_NodeType, class T_ConnectionType>
+		void FillWindow(int originCol, int originRow, int columns, int rows, GridGraph<T_NodeType, T_ConnectionType>& window);
+
+		enum class PathResult
+		{
+			Found,
+			NoPath, // start or goal blocked, or the goal can't be reached
+			ExpansionLimitReached, // the search gave up, the goal may still be reachable
+			TileLoadFailed // a tile the search needed couldn't be read, it was treated as Water (path is set if one was found around it)
+		};
+
+		// A* over the whole world through the tile cache (see ChunkedGridGraphView), path gets the cell centers from start to goal
+		// maxExpansions of 0 allows 16 times as many expansions as the tile budget holds cells, the search state grows with them
+		PathResult FindPath(const Vector2& startPos, const Vector2& goalPos, Heuristic hFunction, std::vector<Vector2>& path,
+			int agentSize = 1, int maxExpansions = 0);
+
+		// Writes all modified tiles that are still cached, returns false if one of them couldn't be written
+		bool Flush();
+
+		// Modified tiles that can't be written stay cached, so this can grow past the budget while the disk fails
+		size_t GetNrOfLoadedTiles() const { return m_Tiles.size(); }
+		size_t GetMaxLoadedTiles() const { return m_MaxLoadedTiles; }
+		// Tiles that had a file which couldn't be read (missing files are not counted, those tiles start as Ground)
+		int GetNrOfFailedTileLoads() const { return m_NrOfFailedTileLoads; }
+
+	private:
+		struct Tile
+		{
+			int tileCol;
+			int tileRow;
+			std::vector<uint8_t> terrain;
+			bool isDirty;
+			bool isLoaded; // false if the tile's file couldn't be read, its terrain is all Water then
+		};
+		using TileList = std::list<Tile>; // most recently used tile first
+
+		std::string m_TileDirectory;
+		int m_NrOfColumns;
+		int m_NrOfRows;
+		int m_TileSize;
+		int m_NrOfTileColumns;
+		int m_CellSize;
+
+		bool m_IsConnectedDiagonally;
+		float m_DefaultCostStraight;
+		float m_DefaultCostDiagonal;
+
+		size_t m_MaxLoadedTiles;
+		TileList m_Tiles;
+		std::unordered_map<int, TileList::iterator> m_TileLookup;
+		int m_NrOfFailedTileLoads = 0;
+
+		uint8_t GetTerrainByte(int col, int row);
+		Tile& FetchTile(int tileCol, int tileRow);
+		// Returns false if every cached tile is modified and can't be written
+		bool EvictLeastRecentlyUsedTile();
+		// A missing file gives an all Ground tile, returns false for a file that can't be read or holds invalid terrain
+		bool LoadTile(Tile& tile) const;
+		bool SaveTile(const Tile& tile) const;
+		std::string GetTilePath(int tileCol, int tileRow) const;
+
+		//C++ make the class non-copyable
+		ChunkedGridGraph(const ChunkedGridGraph&) = delete;
+		ChunkedGridGraph& operator=(const ChunkedGridGraph&) = delete;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ChunkedGridGraph::FillWindow(int originCol, int originRow, int columns, int rows, GridGraph<T_NodeType, T_ConnectionType>& window)
+	{
+		// Connection costs follow from the terrain, so the window doesn't need to be directional
+		window.InitializeGrid(columns, rows, m_CellSize, false, m_IsConnectedDiagonally, m_DefaultCostStraight, m_DefaultCostDiagonal);
+
+		// Walk row by row so consecutive cells come from the same tile
+		for (int r = 0; r < rows; ++r)
+		{
+			for (int c = 0; c < columns; ++c)
+			{
+				int col = originCol + c;
+				int row = originRow + r;
+				TerrainType terrain = IsWithinBounds(col, row) ? ByteToTerrainType(GetTerrainByte(col, row)) : TerrainType::Water;
+				window.SetTerrainType(window.GetIndex(c, r), terrain);
+			}
+		}
+
+		window.RebuildConnections();
+	}
+
+	template<class T_Visit>
+	inline void ChunkedGridGraph::ForEachNeighbor(int col, int row, T_Visit&& visit)
+	{
+		static const int directions[8][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+		if (!IsWithinBounds(col, row))
+			return;
+
+		const float fromCost = float(ByteToTerrainType(GetTerrainByte(col, row)));
+		const int nrOfDirections = m_IsConnectedDiagonally ? 8 : 4;
+
+		for (int d = 0; d < nrOfDirections; ++d)
+		{
+			int neighborCol = col + directions[d][0];
+			int neighborRow = row + directions[d][1];
+			if (!IsWithinBounds(neighborCol, neighborRow))
+				continue;
+
+			// Same cost as GridGraph::CalculateConnectionCost
+			float cost = (d < 4 ? m_DefaultCostStraight : m_DefaultCostDiagonal)
+				* (fromCost + float(ByteToTerrainType(GetTerrainByte(neighborCol, neighborRow)))) / 2.0f;
+
+			if (cost < 100000) //Extra check for different terrain types
+				visit(neighborCol, neighborRow, cost);
+		}
+	}
+
+	// ChunkedGridGraph as a graph view (see EGraphViews.h), node indices are row * columns + col and positions are (column, row)
+	// Every query goes through the tile cache, so searches can cross the whole world with only the budgeted tiles in memory.
+	// Use hashed search records (HashedSearchRecords), dense ones would allocate the whole world.
+	class ChunkedGridGraphView
+	{
+	public:
+		ChunkedGridGraphView(ChunkedGridGraph* pGraph, int agentSize = 1) : m_pGraph(pGraph), m_AgentSize(agentSize)
+		{
+			assert(int64_t(pGraph->GetColumns()) * pGraph->GetRows() <= std::numeric_limits<int>::max()
+				&& "<ChunkedGridGraphView>: the world has more cells than node indices can address");
+		}
+
+		int GetNrOfNodes() const { return m_pGraph->GetColumns() * m_pGraph->GetRows(); }
+		int GetIndex(int col, int row) const { return row * m_pGraph->GetColumns() + col; }
+		Vector2 GetPosition(int idx) const { return Vector2{ float(idx % m_pGraph->GetColumns()), float(idx / m_pGraph->GetColumns()) }; }
+
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const
+		{
+			m_pGraph->ForEachNeighbor(idx % m_pGraph->GetColumns(), idx / m_pGraph->GetColumns(), [&](int col, int row, float cost)
+				{
+					if (m_AgentSize == 1 || m_pGraph->CanFitAgent(col, row, m_AgentSize))
+						visit(GetIndex(col, row), cost);
+				});
+		}
+
+	private:
+		ChunkedGridGraph* m_pGraph;
+		int m_AgentSize;
+	};
+}
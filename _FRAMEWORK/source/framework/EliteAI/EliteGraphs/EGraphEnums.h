@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 
 enum
 {
@@ -12,4 +13,40 @@ enum class TerrainType : int
 	Mud = 3,
 	// Node's with a value of over 200 000 are always isolated
 	Water = 200001
-};
\ No newline at end of file
+};
+
+// Order in which GridGraph stores its cells, node indices and all per-cell arrays follow it
+// Tiled keeps square blocks of cells together so the neighbours above and below are usually in the same cache line
+enum class GridLayout : int
+{
+	RowMajor,
+	Tiled
+};
+
+// Search modes of AStar, the bounded suboptimal ones trade path length for fewer expansions
+enum class SearchMode : int
+{
+	Optimal,
+	WeightedAStar,
+	Focal
+};
+
+// GridGraph stores its terrain as one byte per cell, these convert between that byte and the TerrainType
+inline uint8_t TerrainTypeToByte(TerrainType terrain)
+{
+	switch (terrain)
+	{
+	case TerrainType::Mud:
+		return 1;
+	case TerrainType::Water:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+inline TerrainType ByteToTerrainType(uint8_t terrainByte)
+{
+	static const TerrainType terrainTypes[] = { TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
+	return terrainTypes[terrainByte];
+}
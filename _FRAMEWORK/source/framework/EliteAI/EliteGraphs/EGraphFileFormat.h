@@ -0,0 +1,149 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphFileFormat.h: Versioned binary layouts for baked graphs, written as raw structs and read back straight from a memory mapped file
+/*=============================================================================*/
+#pragma once
+
+#include <cstdint>
+
+namespace Elite
+{
+	namespace GraphFileFormat
+	{
+		const uint32_t GridGraphMagic = 0x44524745; // "EGRD"
+		const uint32_t GridGraphVersion = 1;
+
+		const uint32_t NavGraphMagic = 0x56414E45; // "ENAV"
+		const uint32_t NavGraphVersion = 1;
+
+		// Every block in a file starts at a multiple of this, so it can be read in place
+		// Offsets are computed in 64 bits, record counts are 32 bits so their sizes can't overflow them
+		const uint64_t BlockAlignment = 4;
+		inline uint64_t AlignBlock(uint64_t offset) { return (offset + BlockAlignment - 1) & ~(BlockAlignment - 1); }
+
+		// --- GridGraph ---
+		// Header | terrain bytes (columns * rows) | padding | ConnectionCostOverride[nrOfCostOverrides]
+		enum GridGraphFlags : uint32_t
+		{
+			GridFlag_Directional = 1 << 0,
+			GridFlag_ConnectedDiagonally = 1 << 1,
+			GridFlag_TiledLayout = 1 << 2 // terrain and override indices are in GridLayout::Tiled order
+		};
+
+		struct GridGraphHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			int32_t columns;
+			int32_t rows;
+			int32_t cellSize;
+			uint32_t flags;
+			float costStraight;
+			float costDiagonal;
+			uint32_t nrOfCostOverrides;
+		};
+
+		// Connections that differ from what the terrain would generate, a negative cost means the connection was removed
+		struct ConnectionCostOverride
+		{
+			int32_t from;
+			int32_t to;
+			float cost;
+		};
+
+		// --- CompressedPathDatabase ---
+		// Header | uint32 rowOffsets[columns * rows + 1] | uint32 runs[nrOfRuns]
+		// A run is (first target index << 4) | first move, the runs of a source cell are sorted on target
+		const uint32_t PathDatabaseMagic = 0x44504345; // "ECPD"
+		const uint32_t PathDatabaseVersion = 1;
+
+		struct PathDatabaseHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			int32_t columns;
+			int32_t rows;
+			uint32_t flags; // GridGraphFlags of the grid it was built for
+			uint32_t nrOfRuns;
+		};
+
+		// --- GoalBounding ---
+		// Header | GoalBox[columns * rows * 8], the boxes of a cell are in the order of GridFirstMoves' directions
+		const uint32_t GoalBoundingMagic = 0x42424745; // "EGBB"
+		const uint32_t GoalBoundingVersion = 1;
+
+		struct GoalBoundingHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			int32_t columns;
+			int32_t rows;
+			uint32_t flags; // GridGraphFlags of the grid it was built for
+			int32_t agentSize;
+		};
+
+		// Inclusive column/row range, empty when minCol > maxCol
+		struct GoalBox
+		{
+			uint16_t minCol;
+			uint16_t minRow;
+			uint16_t maxCol;
+			uint16_t maxRow;
+		};
+
+		// --- NavGraph ---
+		// Header | PolygonChild[nrOfChildren] | Point[nrOfPoints] (outer shape first, then every child)
+		// | TriangleRecord[nrOfTriangles] | LineRecord[nrOfLines] | NodeRecord[nrOfNodes] | ConnectionRecord[nrOfConnections]
+		struct NavGraphHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t nrOfOuterPoints;
+			uint32_t nrOfChildren;
+			uint32_t nrOfPoints;
+			uint32_t nrOfTriangles;
+			uint32_t nrOfLines;
+			uint32_t nrOfNodes;
+			uint32_t nrOfConnections;
+		};
+
+		struct PolygonChild
+		{
+			uint32_t nrOfPoints;
+		};
+
+		struct Point
+		{
+			float x;
+			float y;
+		};
+
+		struct TriangleRecord
+		{
+			Point points[3];
+			int32_t lineIndices[3];
+		};
+
+		struct LineRecord
+		{
+			Point p1;
+			Point p2;
+			int32_t index;
+		};
+
+		// The node index is its position in the node block
+		struct NodeRecord
+		{
+			int32_t lineIndex;
+			Point position;
+		};
+
+		struct ConnectionRecord
+		{
+			int32_t from;
+			int32_t to;
+			float cost;
+		};
+	}
+}
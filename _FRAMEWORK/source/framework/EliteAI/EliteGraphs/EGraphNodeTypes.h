@@ -50,21 +50,17 @@ namespace Elite
 	};
 
 
+	// Cell of a terrain grid, the terrain itself lives in the owning GridGraph (GridGraph::GetTerrainType/SetTerrainType)
+	// so a node is no bigger than a plain GraphNode
 	class GridTerrainNode : public GraphNode
 	{
 	public:
-		GridTerrainNode(int index)
-			: GraphNode(index), m_Terrain(TerrainType::Ground)
-		{
-		}
+		GridTerrainNode(int index) : GraphNode(index) {}
 		virtual ~GridTerrainNode() = default;
 
-
-		TerrainType GetTerrainType() const { return m_Terrain; }
-		void SetTerrainType(TerrainType terrain) { m_Terrain = terrain; }
-		Elite::Color GetColor() const 
+		static Elite::Color GetTerrainColor(TerrainType terrain)
 		{
-			switch (m_Terrain)
+			switch (terrain)
 			{
 			case TerrainType::Mud:
 				return MUD_NODE_COLOR;
@@ -77,10 +73,6 @@ namespace Elite
 				break;
 			}
 		}
-		
-
-	protected:
-		TerrainType m_Terrain;
 	};
 
 
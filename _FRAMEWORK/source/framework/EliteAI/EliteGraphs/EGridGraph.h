@@ -9,27 +9,62 @@
 #include "EIGraph.h"
 #include "EGraphConnectionTypes.h"
 #include "EGraphNodeTypes.h"
+#include "EGraphFileFormat.h"
+#include "framework/EliteHelpers/EMemoryMappedFile.h"
 
 namespace Elite
 {
+	// Source of GridGraph's terrain chunk stamps, see GridGraph::GetTerrainChunkStamp
+	inline std::atomic<uint64_t> NextTerrainChunkStamp{ 1 };
+
 	template<class T_NodeType, class T_ConnectionType>
 	class GridGraph : public IGraph<T_NodeType, T_ConnectionType>
 	{
 	public:
 		GridGraph(bool isDirectional);
-		GridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
-		void InitializeGrid(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
+		GridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5, GridLayout layout = GridLayout::RowMajor);
+		GridGraph(const GridGraph& other);
+		void InitializeGrid(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5, GridLayout layout = GridLayout::RowMajor);
 
 		using IGraph::GetNode;
-		T_NodeType* GetNode(int col, int row) const { return m_Nodes[GetIndex(col, row)]; }
-		const ConnectionList& GetConnections(const T_NodeType& node) const { return m_Connections[node.GetIndex()]; }
-		const ConnectionList& GetConnections(int idx) const { return m_Connections[idx]; }
+		T_NodeType* GetNode(int col, int row) const { return GetNode(GetIndex(col, row)); }
+		const ConnectionList& GetConnections(const T_NodeType& node) const { return GetNodeConnections(node.GetIndex()); }
+		const ConnectionList& GetConnections(int idx) const { return GetNodeConnections(idx); }
 
 		int GetRows() const { return m_NrOfRows; }
 		int GetColumns() const { return m_NrOfColumns; }
+		bool IsConnectedDiagonally() const { return m_IsConnectedDiagonally; }
+		float GetDefaultCostStraight() const { return m_DefaultCostStraight; }
+		float GetDefaultCostDiagonal() const { return m_DefaultCostDiagonal; }
+		GridLayout GetLayout() const { return m_Layout; }
 
+		// Cell <-> index conversion, don't compute indices by hand since they depend on the layout
 		bool IsWithinBounds(int col, int row) const;
-		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
+		int GetIndex(int col, int row) const;
+		void GetColRow(int idx, int& col, int& row) const;
+
+		// Terrain is stored as one byte per cell here, the node objects don't hold it
+		TerrainType GetTerrainType(int idx) const { return ByteToTerrainType(m_Terrain[idx]); }
+		void SetTerrainType(int idx, TerrainType terrain);
+		bool IsWalkable(int idx) const { return idx >= 0 && idx < (int)m_Terrain.size() && m_Terrain[idx] != TerrainTypeToByte(TerrainType::Water); }
+		bool IsWalkable(int col, int row) const { return IsWithinBounds(col, row) && m_Terrain[GetIndex(col, row)] != TerrainTypeToByte(TerrainType::Water); }
+		const std::vector<uint8_t>& GetTerrainData() const { return m_Terrain; }
+
+		// Terrain change tracking for copy-on-write snapshots (see GridSnapshot): the grid is split in squares of
+		// TerrainChunkSize cells (chunk index chunkCol + chunkRow * chunk columns) and every change of a chunk's terrain
+		// gives it a new stamp. Stamps are never reused, not even by other grids, so a chunk that still has the stamp it
+		// had when a snapshot was taken holds the same terrain.
+		static constexpr int TerrainChunkSize = 32;
+		int GetNrOfTerrainChunks() const { return int(m_TerrainChunkStamps.size()); }
+		uint64_t GetTerrainChunkStamp(int chunkIdx) const { return m_TerrainChunkStamps[chunkIdx]; }
+
+		// Clearance: size of the largest square of walkable cells that has this cell as its top-left corner (0 for water)
+		// Agents larger than one cell are represented by the top-left cell of the square they cover
+		int GetClearance(int idx) const { return m_Clearance[idx]; }
+		bool CanFitAgent(int idx, int agentSize) const override { return idx >= 0 && idx < (int)m_Clearance.size() && m_Clearance[idx] >= agentSize; }
+		int GetAgentSize(float agentRadius) const { return std::max(1, int(ceilf(2.f * agentRadius / m_CellSize))); }
+		int GetAnchorIdxAtWorldPos(const Elite::Vector2& pos, int agentSize) const;
+		Vector2 GetAnchorWorldPos(int anchorIdx, int agentSize) const;
 
 		// returns the column and row of the node in a Vector2
 		using IGraph::GetNodePos;
@@ -44,23 +79,62 @@ namespace Elite
 
 		void AddConnectionsToAdjacentCells(int col, int row);
 		void AddConnectionsToAdjacentCells(int idx);
+
+		// Drops all connections and generates them again from the current terrain
+		void RebuildConnections();
+
+		// Binary baking (see EGraphFileFormat.h): terrain plus the connections that differ from what the terrain generates
+		// Loading replaces the whole graph and returns false if the file is missing, of another version, truncated or holds
+		// values the grid can't use. It only copies the terrain block and computes the clearance, the node and connection
+		// objects are created the first time something asks for them. Terrain, clearance and cell queries, ImplicitGridView
+		// and GridSnapshot work on the loaded grid without creating them.
+		bool SaveToFile(const std::string& filePath) const;
+		bool LoadFromFile(const std::string& filePath);
+
+	protected:
+		// Creates the nodes and connections of a loaded grid, see IGraph::DeferBuild
+		void BuildDeferred() override;
+
 	private:
-		
+		// Side of a block in GridLayout::Tiled, 8x8 terrain bytes fill one cache line (has to be a power of two)
+		static constexpr int TileSize = 8;
+
 		int m_NrOfColumns;
 		int m_NrOfRows;
 		int m_CellSize;
+		GridLayout m_Layout;
 
 		bool m_IsConnectedDiagonally;
 		float m_DefaultCostStraight;
 		float m_DefaultCostDiagonal;
 
+		std::vector<uint8_t> m_Terrain;
+		std::vector<uint8_t> m_Clearance; // capped at 255
+		std::vector<uint64_t> m_TerrainChunkStamps;
+
+		// Connections of a loaded file that differ from the generated ones, applied by BuildDeferred
+		std::vector<GraphFileFormat::ConnectionCostOverride> m_PendingCostOverrides;
+
 		const vector<Vector2> m_StraightDirections = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
 		const vector<Vector2> m_DiagonalDirections = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
 
 		// graph creation helper functions
 		void AddConnectionsInDirections(int idx, int col, int row, vector<Vector2> directions);
+		void CreateNodes();
+		// Generates the connections of every cell straight from the terrain, the connection lists have to be empty
+		void BuildConnections();
+		void AddOutgoingConnections(int idx, int col, int row, const vector<Vector2>& directions);
 
 		float CalculateConnectionCost(int fromIdx, int toIdx) const;
+
+		// New stamps for every terrain chunk, after the whole terrain was replaced
+		void ResetTerrainChunkStamps();
+		static uint64_t CreateTerrainChunkStamp();
+
+		uint8_t CalculateClearance(int col, int row) const;
+		void RecalculateClearance();
+		// Only cells up and to the left of an edited cell can change, walks back until a row no longer changes
+		void UpdateClearance(int col, int row);
 	
 		friend class GraphRenderer;
 	};
@@ -71,6 +145,7 @@ namespace Elite
 		, m_NrOfColumns(0)
 		, m_NrOfRows(0)
 		, m_CellSize(5)
+		, m_Layout(GridLayout::RowMajor)
 		, m_IsConnectedDiagonally(true)
 		, m_DefaultCostStraight(1.f)
 		, m_DefaultCostDiagonal(1.5f)
@@ -85,16 +160,34 @@ namespace Elite
 		bool isDirectionalGraph, 
 		bool isConnectedDiagonally, 
 		float costStraight /* = 1.f*/, 
-		float costDiagonal /* = 1.5f */)
+		float costDiagonal /* = 1.5f */,
+		GridLayout layout /* = GridLayout::RowMajor */)
 		: IGraph(isDirectionalGraph)
 		, m_NrOfColumns(columns)
 		, m_NrOfRows(rows)
 		, m_CellSize(cellSize)
+		, m_Layout(layout)
 		, m_IsConnectedDiagonally(isConnectedDiagonally)
 		, m_DefaultCostStraight(costStraight)
 		, m_DefaultCostDiagonal(costDiagonal)
 	{
-		InitializeGrid(columns, rows, cellSize, isDirectionalGraph, isConnectedDiagonally, costStraight, costDiagonal);
+		InitializeGrid(columns, rows, cellSize, isDirectionalGraph, isConnectedDiagonally, costStraight, costDiagonal, layout);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline GridGraph<T_NodeType, T_ConnectionType>::GridGraph(const GridGraph& other)
+		: IGraph(other)
+		, m_NrOfColumns(other.m_NrOfColumns)
+		, m_NrOfRows(other.m_NrOfRows)
+		, m_CellSize(other.m_CellSize)
+		, m_Layout(other.m_Layout)
+		, m_IsConnectedDiagonally(other.m_IsConnectedDiagonally)
+		, m_DefaultCostStraight(other.m_DefaultCostStraight)
+		, m_DefaultCostDiagonal(other.m_DefaultCostDiagonal)
+		, m_Terrain(other.m_Terrain)
+		, m_Clearance(other.m_Clearance)
+		, m_TerrainChunkStamps(other.m_TerrainChunkStamps)
+	{
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -105,33 +198,376 @@ namespace Elite
 		bool isDirectionalGraph,
 		bool isConnectedDiagonally, 
 		float costStraight /* = 1.f*/,
-		float costDiagonal /* = 1.5f */)
+		float costDiagonal /* = 1.5f */,
+		GridLayout layout /* = GridLayout::RowMajor */)
 	{
 		m_IsDirectionalGraph = isDirectionalGraph;
 		m_NrOfColumns = columns;
 		m_NrOfRows = rows;
 		m_CellSize = cellSize;
+		m_Layout = layout;
 		m_IsConnectedDiagonally = isConnectedDiagonally;
 		m_DefaultCostStraight = costStraight;
 		m_DefaultCostDiagonal = costDiagonal;
 
-		// Create all nodes
+		m_Terrain.assign(size_t(m_NrOfColumns) * m_NrOfRows, TerrainTypeToByte(TerrainType::Ground));
+		RecalculateClearance();
+		ResetTerrainChunkStamps();
+
+		CreateNodes();
+		BuildConnections();
+
+		OnGraphModified(false, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::CreateNodes()
+	{
+		// Nodes have to be added in index order, which is only row by row for GridLayout::RowMajor
+		const int nrOfCells = m_NrOfColumns * m_NrOfRows;
+		for (int idx = 0; idx < nrOfCells; ++idx)
+		{
+			AddNode(new T_NodeType(idx));
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::BuildConnections()
+	{
+		// Every cell creates its own outgoing connections, so undirected graphs don't need the opposite ones added separately
+		InvalidateComponents();
+
 		for (auto r = 0; r < m_NrOfRows; ++r)
 		{
 			for (auto c = 0; c < m_NrOfColumns; ++c)
 			{
 				int idx = GetIndex(c, r);
-				AddNode(new T_NodeType(idx));
+				AddOutgoingConnections(idx, c, r, m_StraightDirections);
+
+				if (m_IsConnectedDiagonally)
+					AddOutgoingConnections(idx, c, r, m_DiagonalDirections);
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::RebuildConnections()
+	{
+		EnsureBuilt();
+
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto& pConnection : connectionList)
+				SAFE_DELETE(pConnection);
+			connectionList.clear();
+		}
+
+		BuildConnections();
+
+		OnGraphModified(false, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::AddOutgoingConnections(int idx, int col, int row, const vector<Vector2>& directions)
+	{
+		for (const auto& d : directions)
+		{
+			int neighborCol = col + (int)d.x;
+			int neighborRow = row + (int)d.y;
+
+			if (IsWithinBounds(neighborCol, neighborRow))
+			{
+				int neighborIdx = GetIndex(neighborCol, neighborRow);
+				float connectionCost = CalculateConnectionCost(idx, neighborIdx);
+
+				if (connectionCost < 100000) //Extra check for different terrain types
+					m_Connections[idx].push_back(new T_ConnectionType(idx, neighborIdx, connectionCost));
 			}
 		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool GridGraph<T_NodeType, T_ConnectionType>::SaveToFile(const std::string& filePath) const
+	{
+		using namespace GraphFileFormat;
+
+		EnsureBuilt();
+
+		std::vector<ConnectionCostOverride> costOverrides{};
 
-		// Create connections in each valid direction on each node
 		for (auto r = 0; r < m_NrOfRows; ++r)
 		{
 			for (auto c = 0; c < m_NrOfColumns; ++c)
 			{
-				AddConnectionsToAdjacentCells(c, r);
+				int idx = GetIndex(c, r);
+
+				// Existing connections that the terrain would not generate like this
+				for (auto pConnection : m_Connections[idx])
+				{
+					Vector2 toPos = GetNodePos(pConnection->GetTo());
+					int colDiff = abs(int(toPos.x) - c);
+					int rowDiff = abs(int(toPos.y) - r);
+					bool isAdjacent = colDiff <= 1 && rowDiff <= 1 && (m_IsConnectedDiagonally || colDiff + rowDiff == 1);
+
+					float generatedCost = isAdjacent ? CalculateConnectionCost(idx, pConnection->GetTo()) : 100000.f;
+					if (generatedCost >= 100000 || generatedCost != pConnection->GetCost())
+						costOverrides.push_back({ idx, pConnection->GetTo(), pConnection->GetCost() });
+				}
+
+				// Connections that the terrain would generate but were removed
+				auto addRemovedConnections = [&](const vector<Vector2>& directions)
+				{
+					for (const auto& d : directions)
+					{
+						int neighborCol = c + (int)d.x;
+						int neighborRow = r + (int)d.y;
+						if (!IsWithinBounds(neighborCol, neighborRow))
+							continue;
+
+						int neighborIdx = GetIndex(neighborCol, neighborRow);
+						if (CalculateConnectionCost(idx, neighborIdx) < 100000 && GetConnection(idx, neighborIdx) == nullptr)
+							costOverrides.push_back({ idx, neighborIdx, -1.f });
+					}
+				};
+				addRemovedConnections(m_StraightDirections);
+				if (m_IsConnectedDiagonally)
+					addRemovedConnections(m_DiagonalDirections);
+			}
+		}
+
+		std::ofstream file{ filePath, std::ios::binary };
+		if (!file)
+			return false;
+
+		GridGraphHeader header{};
+		header.magic = GridGraphMagic;
+		header.version = GridGraphVersion;
+		header.columns = m_NrOfColumns;
+		header.rows = m_NrOfRows;
+		header.cellSize = m_CellSize;
+		header.flags = (m_IsDirectionalGraph ? GridFlag_Directional : 0)
+			| (m_IsConnectedDiagonally ? GridFlag_ConnectedDiagonally : 0)
+			| (m_Layout == GridLayout::Tiled ? GridFlag_TiledLayout : 0);
+		header.costStraight = m_DefaultCostStraight;
+		header.costDiagonal = m_DefaultCostDiagonal;
+		header.nrOfCostOverrides = uint32_t(costOverrides.size());
+
+		const size_t terrainEnd = sizeof(GridGraphHeader) + m_Terrain.size();
+		const char padding[BlockAlignment]{};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(m_Terrain.data()), m_Terrain.size());
+		file.write(padding, AlignBlock(terrainEnd) - terrainEnd);
+		file.write(reinterpret_cast<const char*>(costOverrides.data()), costOverrides.size() * sizeof(ConnectionCostOverride));
+
+		return file.good();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool GridGraph<T_NodeType, T_ConnectionType>::LoadFromFile(const std::string& filePath)
+	{
+		using namespace GraphFileFormat;
+
+		MemoryMappedFile file{ filePath };
+
+		const GridGraphHeader* pHeader = file.GetAt<GridGraphHeader>(0);
+		if (pHeader == nullptr
+			|| pHeader->magic != GridGraphMagic
+			|| pHeader->version != GridGraphVersion
+			|| pHeader->columns <= 0 || pHeader->rows <= 0
+			|| pHeader->cellSize <= 0)
+			return false;
+
+		// Node indices are ints
+		const uint64_t nrOfCells = uint64_t(pHeader->columns) * uint64_t(pHeader->rows);
+		if (nrOfCells > uint64_t(std::numeric_limits<int>::max()))
+			return false;
+
+		const uint64_t terrainOffset = sizeof(GridGraphHeader);
+		const uint64_t overridesOffset = AlignBlock(terrainOffset + nrOfCells);
+
+		const uint8_t* pTerrain = file.GetAt<uint8_t>(terrainOffset, nrOfCells);
+		const ConnectionCostOverride* pOverrides = file.GetAt<ConnectionCostOverride>(overridesOffset, pHeader->nrOfCostOverrides);
+		if (pTerrain == nullptr || (pOverrides == nullptr && pHeader->nrOfCostOverrides > 0))
+			return false;
+
+		// ByteToTerrainType only knows the bytes up to Water
+		const uint8_t maxTerrainByte = TerrainTypeToByte(TerrainType::Water);
+		if (std::any_of(pTerrain, pTerrain + nrOfCells, [maxTerrainByte](uint8_t terrainByte) { return terrainByte > maxTerrainByte; }))
+			return false;
+
+		Clear();
+
+		m_IsDirectionalGraph = (pHeader->flags & GridFlag_Directional) != 0;
+		m_IsConnectedDiagonally = (pHeader->flags & GridFlag_ConnectedDiagonally) != 0;
+		m_NrOfColumns = pHeader->columns;
+		m_NrOfRows = pHeader->rows;
+		m_CellSize = pHeader->cellSize;
+		m_Layout = (pHeader->flags & GridFlag_TiledLayout) != 0 ? GridLayout::Tiled : GridLayout::RowMajor;
+		m_DefaultCostStraight = pHeader->costStraight;
+		m_DefaultCostDiagonal = pHeader->costDiagonal;
+
+		// The terrain block is copied as a whole, the nodes and connections follow from it once they are needed
+		m_Terrain.assign(pTerrain, pTerrain + size_t(nrOfCells));
+		RecalculateClearance();
+		ResetTerrainChunkStamps();
+
+		m_PendingCostOverrides.assign(pOverrides, pOverrides + pHeader->nrOfCostOverrides);
+		DeferBuild();
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::BuildDeferred()
+	{
+		CreateNodes();
+		BuildConnections();
+
+		const int nrOfCells = m_NrOfColumns * m_NrOfRows;
+		for (const GraphFileFormat::ConnectionCostOverride& costOverride : m_PendingCostOverrides)
+		{
+			if (costOverride.from < 0 || costOverride.from >= nrOfCells
+				|| costOverride.to < 0 || costOverride.to >= nrOfCells)
+				continue;
+
+			auto& connections = m_Connections[costOverride.from];
+			auto foundIt = std::find_if(connections.begin(), connections.end(),
+				[&costOverride](T_ConnectionType* pConnection) { return pConnection->GetTo() == costOverride.to; });
+
+			if (costOverride.cost < 0.f)
+			{
+				if (foundIt != connections.end())
+				{
+					delete *foundIt;
+					connections.erase(foundIt);
+				}
+			}
+			else if (foundIt != connections.end())
+			{
+				(*foundIt)->SetCost(costOverride.cost);
 			}
+			else
+			{
+				connections.push_back(new T_ConnectionType(costOverride.from, costOverride.to, costOverride.cost));
+			}
+		}
+		std::vector<GraphFileFormat::ConnectionCostOverride>().swap(m_PendingCostOverrides);
+
+		OnGraphModified(true, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::SetTerrainType(int idx, TerrainType terrain)
+	{
+		if (m_Terrain[idx] == TerrainTypeToByte(terrain))
+			return;
+
+		bool wasWalkable = IsWalkable(idx);
+		m_Terrain[idx] = TerrainTypeToByte(terrain);
+
+		int col, row;
+		GetColRow(idx, col, row);
+		const int nrOfChunkColumns = (m_NrOfColumns + TerrainChunkSize - 1) / TerrainChunkSize;
+		m_TerrainChunkStamps[(row / TerrainChunkSize) * nrOfChunkColumns + col / TerrainChunkSize] = CreateTerrainChunkStamp();
+
+		if (wasWalkable != IsWalkable(idx))
+			UpdateClearance(col, row);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::ResetTerrainChunkStamps()
+	{
+		const int nrOfChunkColumns = (m_NrOfColumns + TerrainChunkSize - 1) / TerrainChunkSize;
+		const int nrOfChunkRows = (m_NrOfRows + TerrainChunkSize - 1) / TerrainChunkSize;
+		m_TerrainChunkStamps.resize(size_t(nrOfChunkColumns) * nrOfChunkRows);
+		for (uint64_t& stamp : m_TerrainChunkStamps)
+			stamp = CreateTerrainChunkStamp();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline uint64_t GridGraph<T_NodeType, T_ConnectionType>::CreateTerrainChunkStamp()
+	{
+		// Shared by every grid type, stamps of one grid can't match those of another
+		return NextTerrainChunkStamp++;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int GridGraph<T_NodeType, T_ConnectionType>::GetAnchorIdxAtWorldPos(const Elite::Vector2& pos, int agentSize) const
+	{
+		// The agent is centered on its square, so the anchor lies half the square up and to the left
+		float offset = (agentSize - 1) * m_CellSize / 2.f;
+		return GetNodeIdxAtWorldPos({ pos.x - offset, pos.y - offset });
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline Vector2 GridGraph<T_NodeType, T_ConnectionType>::GetAnchorWorldPos(int anchorIdx, int agentSize) const
+	{
+		float offset = (agentSize - 1) * m_CellSize / 2.f;
+		return GetNodeWorldPos(anchorIdx) + Vector2{ offset, offset };
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline uint8_t GridGraph<T_NodeType, T_ConnectionType>::CalculateClearance(int col, int row) const
+	{
+		if (!IsWalkable(col, row))
+			return 0;
+
+		auto clearanceAt = [this](int c, int r) { return IsWithinBounds(c, r) ? int(m_Clearance[GetIndex(c, r)]) : 0; };
+		int clearance = 1 + std::min({ clearanceAt(col + 1, row), clearanceAt(col, row + 1), clearanceAt(col + 1, row + 1) });
+
+		return uint8_t(std::min(clearance, 255));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::RecalculateClearance()
+	{
+		m_Clearance.assign(m_Terrain.size(), 0);
+
+		// Each cell depends on its right, lower and lower right neighbour, so fill from the last cell back
+		for (int r = m_NrOfRows - 1; r >= 0; --r)
+		{
+			for (int c = m_NrOfColumns - 1; c >= 0; --c)
+				m_Clearance[GetIndex(c, r)] = CalculateClearance(c, r);
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::UpdateClearance(int col, int row)
+	{
+		// Columns [minCol, maxCol] of the current row have to be recalculated
+		int minCol = col;
+		int maxCol = col;
+
+		for (int r = row; r >= 0; --r)
+		{
+			int minChangedCol = m_NrOfColumns;
+			int maxChangedCol = -1;
+
+			// Keep going left past the range as long as cells change, they depend on their right neighbour
+			for (int c = maxCol; c >= 0; --c)
+			{
+				int idx = GetIndex(c, r);
+				uint8_t clearance = CalculateClearance(c, r);
+				bool hasChanged = clearance != m_Clearance[idx];
+				m_Clearance[idx] = clearance;
+
+				if (hasChanged)
+				{
+					minChangedCol = std::min(minChangedCol, c);
+					maxChangedCol = std::max(maxChangedCol, c);
+				}
+				else if (c <= minCol)
+				{
+					break;
+				}
+			}
+
+			if (maxChangedCol < 0)
+				break;
+
+			// The row above depends on the changed cells and on the cells directly left of them
+			minCol = std::max(minChangedCol - 1, 0);
+			maxCol = maxChangedCol;
 		}
 	}
 
@@ -141,6 +577,48 @@ namespace Elite
 		return (col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows);
 	}
 
+	template<class T_NodeType, class T_ConnectionType>
+	inline int GridGraph<T_NodeType, T_ConnectionType>::GetIndex(int col, int row) const
+	{
+		if (m_Layout == GridLayout::RowMajor)
+			return row * m_NrOfColumns + col;
+
+		// Tiles are stored row by row and each tile row by row, the tiles on the right and bottom edge are
+		// narrower/shorter so the indices stay dense for any grid size
+		const int tileColStart = col & ~(TileSize - 1);
+		const int tileRowStart = row & ~(TileSize - 1);
+		const int tileWidth = std::min(TileSize, m_NrOfColumns - tileColStart);
+		const int tileHeight = std::min(TileSize, m_NrOfRows - tileRowStart);
+
+		return tileRowStart * m_NrOfColumns
+			+ tileColStart * tileHeight
+			+ (row & (TileSize - 1)) * tileWidth
+			+ (col & (TileSize - 1));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::GetColRow(int idx, int& col, int& row) const
+	{
+		if (m_Layout == GridLayout::RowMajor)
+		{
+			col = idx % m_NrOfColumns;
+			row = idx / m_NrOfColumns;
+			return;
+		}
+
+		// Inverse of GetIndex, all tiles before the one we're in are full width
+		const int tileRow = idx / (TileSize * m_NrOfColumns);
+		int offset = idx - tileRow * TileSize * m_NrOfColumns;
+
+		const int tileHeight = std::min(TileSize, m_NrOfRows - tileRow * TileSize);
+		const int tileCol = offset / (TileSize * tileHeight);
+		offset -= tileCol * TileSize * tileHeight;
+
+		const int tileWidth = std::min(TileSize, m_NrOfColumns - tileCol * TileSize);
+		col = tileCol * TileSize + offset % tileWidth;
+		row = tileRow * TileSize + offset / tileWidth;
+	}
+
 
 	template<class T_NodeType, class T_ConnectionType>
 	void GridGraph<T_NodeType, T_ConnectionType>::AddConnectionsToAdjacentCells(int col, int row)
@@ -175,7 +653,7 @@ namespace Elite
 			
 			if (IsWithinBounds(neighborCol, neighborRow)) 
 			{
-				int neighborIdx = neighborRow * m_NrOfColumns + neighborCol;
+				int neighborIdx = GetIndex(neighborCol, neighborRow);
 				float connectionCost = CalculateConnectionCost(idx, neighborIdx);
 
 				if (IsUniqueConnection(idx, neighborIdx) 
@@ -190,33 +668,16 @@ namespace Elite
 	{
 		float cost = m_DefaultCostStraight;
 
-		Vector2 fromPos = GetNodePos(fromIdx);
-		Vector2 toPos = GetNodePos(toIdx);
-
-		if (int(fromPos.y) != int(toPos.y) &&
-			int(fromPos.x) != int(toPos.x))
+		int fromCol, fromRow, toCol, toRow;
+		GetColRow(fromIdx, fromCol, fromRow);
+		GetColRow(toIdx, toCol, toRow);
+		if (fromRow != toRow && fromCol != toCol)
 		{
 			cost = m_DefaultCostDiagonal;
 		}
 
-		return cost;
-	}
-
-	template<>
-	inline float GridGraph<GridTerrainNode, GraphConnection>::CalculateConnectionCost(int fromIdx, int toIdx) const
-	{
-		float cost = m_DefaultCostStraight;
-
-		Vector2 fromPos = GetNodePos(fromIdx);
-		Vector2 toPos = GetNodePos(toIdx);
-
-		if (int(fromPos.y) != int(toPos.y) &&
-			int(fromPos.x) != int(toPos.x))
-		{
-			cost = m_DefaultCostDiagonal;
-		}
-
-		cost *= (int(GetNode(fromIdx)->GetTerrainType()) + int(GetNode(toIdx)->GetTerrainType())) / 2.0f;
+		// Node types without terrain are always Ground, which doesn't change the cost
+		cost *= (int(ByteToTerrainType(m_Terrain[fromIdx])) + int(ByteToTerrainType(m_Terrain[toIdx]))) / 2.0f;
 
 		return cost;
 	}
@@ -224,8 +685,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	Elite::Vector2 GridGraph<T_NodeType, T_ConnectionType>::GetNodePos(T_NodeType* pNode) const
 	{
-		auto col = pNode->GetIndex() % m_NrOfColumns;
-		auto row = pNode->GetIndex() / m_NrOfColumns;
+		int col, row;
+		GetColRow(pNode->GetIndex(), col, row);
 
 		return Vector2{ float(col), float(row) };
 	}
@@ -240,8 +701,9 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	Elite::Vector2 GridGraph<T_NodeType, T_ConnectionType>::GetNodeWorldPos(int idx) const
 	{
-		auto colRow = GetNodePos(idx);
-		return GetNodeWorldPos((int)colRow.x, (int)colRow.y);
+		int col, row;
+		GetColRow(idx, col, row);
+		return GetNodeWorldPos(col, row);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
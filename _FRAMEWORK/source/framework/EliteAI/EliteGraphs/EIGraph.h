@@ -10,6 +10,10 @@
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
 #include <memory>
+#include <iterator>
+#include <numeric>
+#include <atomic>
+#include <mutex>
 
 namespace Elite
 {
@@ -22,6 +26,50 @@ namespace Elite
 		using ConnectionList = std::list<T_ConnectionType*>; // TODO: function definition doesn't recognize this?
 		using ConnectionListVector = std::vector<ConnectionList>;
 
+		// Forward iterator over m_Nodes that skips removed (invalid_node_index) nodes in place
+		class ActiveNodeIterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = T_NodeType*;
+			using difference_type = std::ptrdiff_t;
+			using pointer = T_NodeType* const*;
+			using reference = T_NodeType* const&;
+
+			ActiveNodeIterator(typename NodeVector::const_iterator it, typename NodeVector::const_iterator end)
+				: m_It(it), m_End(end) { SkipInactiveNodes(); }
+
+			reference operator*() const { return *m_It; }
+			ActiveNodeIterator& operator++() { ++m_It; SkipInactiveNodes(); return *this; }
+			ActiveNodeIterator operator++(int) { ActiveNodeIterator tmp{ *this }; ++(*this); return tmp; }
+
+			bool operator==(const ActiveNodeIterator& other) const { return m_It == other.m_It; }
+			bool operator!=(const ActiveNodeIterator& other) const { return m_It != other.m_It; }
+
+		private:
+			void SkipInactiveNodes() { while (m_It != m_End && (*m_It)->GetIndex() == invalid_node_index) ++m_It; }
+
+			typename NodeVector::const_iterator m_It;
+			typename NodeVector::const_iterator m_End;
+		};
+
+		// Non-owning view over the active nodes, usable in range-based for loops without allocating
+		// Only valid as long as the graph's node vector is not modified
+		class ActiveNodeRange
+		{
+		public:
+			explicit ActiveNodeRange(const NodeVector& nodes) : m_pNodes(&nodes) {}
+
+			ActiveNodeIterator begin() const { return ActiveNodeIterator(m_pNodes->cbegin(), m_pNodes->cend()); }
+			ActiveNodeIterator end() const { return ActiveNodeIterator(m_pNodes->cend(), m_pNodes->cend()); }
+
+			bool empty() const { return begin() == end(); }
+			T_NodeType* front() const { assert(!empty() && "<Graph::ActiveNodeRange::front>: no active nodes"); return *begin(); }
+
+		private:
+			const NodeVector* m_pNodes;
+		};
+
 	public:
 		IGraph(bool isDirectionalGraph);
 		IGraph(const IGraph& other);
@@ -31,15 +79,16 @@ namespace Elite
 		// -------------------------
 		T_NodeType* GetNode(int idx) const;
 		bool IsNodeValid(int idx) const;
-		const NodeVector& GetAllNodes() const { return m_Nodes; }
+		const NodeVector& GetAllNodes() const { EnsureBuilt(); return m_Nodes; }
 		NodeVector GetAllActiveNodes() const;
+		ActiveNodeRange GetActiveNodes() const { EnsureBuilt(); return ActiveNodeRange(m_Nodes); }
 
 		T_ConnectionType* GetConnection(int from, int to) const;
-		const ConnectionListVector& GetAllConnections() const { return m_Connections; }
+		const ConnectionListVector& GetAllConnections() const { EnsureBuilt(); return m_Connections; }
 		const ConnectionList& GetNodeConnections(int idx) const;
 		const ConnectionList& GetNodeConnections(T_NodeType* pNode) const { return GetNodeConnections(pNode->GetIndex()); }
 
-		int GetNextFreeNodeIndex() const { return m_NextNodeIndex; }
+		int GetNextFreeNodeIndex() const { EnsureBuilt(); return m_NextNodeIndex; }
 		int AddNode(T_NodeType* pNode);
 		void RemoveNode(int node);
 
@@ -52,16 +101,26 @@ namespace Elite
 
 		void SetConnectionCost(int from, int to, float cost);
 
-		int GetNrOfNodes() const { return m_Nodes.size(); }
+		int GetNrOfNodes() const { EnsureBuilt(); return m_Nodes.size(); }
 		int GetNrOfActiveNodes() const; // TODO: add comment
 		int GetNrOfConnections() const;
 		bool IsDirectionalGraph() const { return m_IsDirectionalGraph; }
-		bool IsEmpty() const { return m_Nodes.empty(); }
+		bool IsEmpty() const { EnsureBuilt(); return m_Nodes.empty(); }
 		bool IsUniqueConnection(int from, int to) const;
 
 		void Clear();
 		void RemoveConnections();
 
+		// Removes all inactive (removed) nodes and renumbers the remaining ones densely, updating all connections
+		// Returns the old-to-new index remap, removed nodes map to invalid_node_index
+		std::vector<int> Compact();
+
+		// Connected components, kept up to date while connections are added and removed
+		// Constant time check meant to reject unreachable goals before searching
+		// Directional graphs use weak connectivity, so there true only means a path might exist
+		bool AreConnected(int from, int to) const;
+		int GetComponentLabel(int idx) const;
+
 		// Visualization
 		// -------------
 		float GetNodeRadius(T_NodeType* pNode) const;
@@ -77,6 +136,9 @@ namespace Elite
 		Vector2 GetNodeWorldPos(T_NodeType* pNode) const { return GetNodeWorldPos(pNode->GetIndex()); }
 
 		virtual int GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const = 0;
+
+		// Lets graphs with a notion of space (e.g. grid clearance) refuse nodes an agent of this size doesn't fit on
+		virtual bool CanFitAgent(int idx, int agentSize) const { return true; }
 		T_NodeType* GetNodeAtWorldPos(const Elite::Vector2& pos) const { return IsNodeValid(GetNodeIdxAtWorldPos(pos)) ? GetNode(GetNodeIdxAtWorldPos(pos)) : nullptr; }
 
 		// Allow derived classes to implement a cloning function that returns a base class pointer
@@ -94,11 +156,36 @@ namespace Elite
 		// Called whenever the graph is modified, to be overriden by derived classes
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
 
+		// Derived classes that fill m_Connections directly have to call this, the components are rebuilt on the next query
+		void InvalidateComponents() { m_AreComponentsDirty = true; }
+
+		// Lets a derived class create its nodes and connections on first use instead of right away (see GridGraph::LoadFromFile)
+		// After DeferBuild every function that touches m_Nodes or m_Connections first calls BuildDeferred, once, from
+		// whichever thread gets there first. Derived classes reading m_Nodes or m_Connections directly call EnsureBuilt.
+		void DeferBuild() { m_IsBuildDeferred = true; }
+		virtual void BuildDeferred() {}
+		void EnsureBuilt() const;
+
 	private:
 		int m_NextNodeIndex;
 
+		// Component label per node index and number of nodes per label
+		mutable std::vector<int> m_ComponentLabels;
+		mutable std::vector<int> m_ComponentSizes;
+		mutable bool m_AreComponentsDirty = true;
+
+		mutable std::atomic<bool> m_IsBuildDeferred{ false };
+		mutable std::recursive_mutex m_DeferredBuildMutex;
+		mutable bool m_IsBuildingDeferred = false;
+
 		// private functions
 		void CullInvalidEdges();
+
+		void RebuildComponents() const;
+		void AddComponent(int idx);
+		void MergeComponents(int a, int b);
+		void SplitComponent(std::vector<int> seeds);
+		void LimitComponentLabels();
 	};
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -111,6 +198,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline IGraph<T_NodeType, T_ConnectionType>::IGraph(const IGraph& other)
 	{
+		other.EnsureBuilt();
+
 		for (auto& n : m_Nodes)
 			SAFE_DELETE(n);
 
@@ -144,6 +233,7 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline T_NodeType* IGraph<T_NodeType, T_ConnectionType>::GetNode(int idx) const
 	{
+		EnsureBuilt();
 		assert((idx < (int)m_Nodes.size()) && (idx >= 0) &&	"<Graph::GetNode>: invalid index");
 
 		return m_Nodes[idx];
@@ -152,12 +242,15 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline bool IGraph<T_NodeType, T_ConnectionType>::IsNodeValid(int idx) const
 	{
+		EnsureBuilt();
 		return (idx < (int)m_Nodes.size() && idx != invalid_node_index);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline T_ConnectionType* IGraph<T_NodeType, T_ConnectionType>::GetConnection(int from, int to) const
 	{
+		EnsureBuilt();
+
 		assert((from < (int)m_Nodes.size()) &&
 			(from >= 0) &&
 			m_Nodes[from]->GetIndex() != invalid_node_index &&
@@ -180,6 +273,7 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline vector<T_NodeType*> IGraph<T_NodeType, T_ConnectionType>::GetAllActiveNodes() const
 	{
+		EnsureBuilt();
 		vector<T_NodeType*> activeNodes{};
 		for (auto n : m_Nodes)
 			if (n->GetIndex() != invalid_node_index)
@@ -191,6 +285,7 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline const std::list<T_ConnectionType*>& IGraph<T_NodeType, T_ConnectionType>::GetNodeConnections(int idx) const
 	{
+		EnsureBuilt();
 		assert((idx < (int)m_Nodes.size()) && (idx >= 0) && "<Graph::GetNode>: invalid index");
 
 		return m_Connections[idx];
@@ -199,6 +294,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int IGraph<T_NodeType, T_ConnectionType>::AddNode(T_NodeType* pNode)
 	{
+		EnsureBuilt();
+
 		if (pNode->GetIndex() < (int)m_Nodes.size())
 		{
 			//make sure the client is not trying to add a pNode with the same ID as
@@ -207,6 +304,7 @@ namespace Elite
 				"<Graph::AddNode>: Attempting to add a node with a duplicate ID");
 
 			m_Nodes[pNode->GetIndex()] = pNode;
+			AddComponent(pNode->GetIndex());
 
 			OnGraphModified(true, false);
 			return m_NextNodeIndex;
@@ -218,6 +316,7 @@ namespace Elite
 
 			m_Nodes.push_back(pNode);
 			m_Connections.push_back(ConnectionList());
+			AddComponent(pNode->GetIndex());
 
 			OnGraphModified(true, false);
 			return m_NextNodeIndex++;
@@ -228,6 +327,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveNode(int idx)
 	{
+		EnsureBuilt();
+
 		//Removes pNode by setting it's index to invalid_node_index 
 		//This prevents the other indices from needing to be changed, however it can be reused when adding a new pNode with that index
 
@@ -238,6 +339,11 @@ namespace Elite
 
 		bool hadConnections = false;
 
+		//its neighbours might end up in different components once the node is gone
+		std::vector<int> neighbors{};
+		for (auto pConnection : m_Connections[idx])
+			neighbors.push_back(pConnection->GetTo());
+
 		//if the graph is not directed remove all connections leading to this pNode and then
 		//clear the connections leading from the pNode
 		if (!m_IsDirectionalGraph)
@@ -273,12 +379,21 @@ namespace Elite
 		}
 		m_Connections[idx].clear();
 
+		if (!m_AreComponentsDirty && idx < (int)m_ComponentLabels.size())
+		{
+			--m_ComponentSizes[m_ComponentLabels[idx]];
+			m_ComponentLabels[idx] = invalid_node_index;
+		}
+		SplitComponent(neighbors);
+
 		OnGraphModified(true, hadConnections);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::AddConnection(T_ConnectionType* pConnection)
 	{
+		EnsureBuilt();
+
 		//first make sure the from and to nodes exist within the graph 
 		assert((pConnection->GetFrom() < m_NextNodeIndex) && (pConnection->GetTo() < m_NextNodeIndex) && (pConnection->GetTo() != pConnection->GetFrom()) &&
 			"<Graph::AddConnection>: invalid node index");
@@ -308,6 +423,8 @@ namespace Elite
 					m_Connections[pConnection->GetTo()].push_back(oppositeDirEdge);
 				}
 			}
+
+			MergeComponents(pConnection->GetFrom(), pConnection->GetTo());
 		}
 		
 		OnGraphModified(false, true);
@@ -316,11 +433,14 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnection(int from, int to)
 	{
+		EnsureBuilt();
+
 		assert((from < (int)m_Nodes.size()) && (to < (int)m_Nodes.size()) &&
 			"<Graph::RemoveConnection>:invalid node index");
 
+		// A directional graph keeps the opposite connection
 		auto conFromTo = GetConnection(from, to);
-		auto conToFrom = GetConnection(to, from);
+		auto conToFrom = m_IsDirectionalGraph ? nullptr : GetConnection(to, from);
 
 		if (!m_IsDirectionalGraph)
 		{
@@ -350,6 +470,8 @@ namespace Elite
 		SAFE_DELETE(conFromTo);
 		SAFE_DELETE(conToFrom);
 
+		SplitComponent({ from, to });
+
 		OnGraphModified(false, true);
 	}
 
@@ -362,9 +484,16 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnectionsToAdjacentNodes(int idx)
 	{
+		EnsureBuilt();
+
+		std::vector<int> neighbors{};
+
 		// remove and delete connections from this pNode
 		for (auto c : m_Connections[idx])
+		{
+			neighbors.push_back(c->GetTo());
 			delete c;
+		}
 		m_Connections[idx].clear();
 
 		// remove and delete connections from other nodes to this pNode
@@ -379,12 +508,22 @@ namespace Elite
 			}
 		}
 
+		// The node is on its own now, its former neighbours might have been split up
+		if (!neighbors.empty() && !m_AreComponentsDirty && !m_IsDirectionalGraph)
+		{
+			--m_ComponentSizes[m_ComponentLabels[idx]];
+			AddComponent(idx);
+		}
+		SplitComponent(neighbors);
+
 		OnGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::SetConnectionCost(int from, int to, float cost)
 	{
+		EnsureBuilt();
+
 		//make sure the nodes given are valid
 		assert((from < (int)m_Nodes.size()) && (to < (int)m_Nodes.size()) &&
 			"<Graph::SetEdgeCost>: invalid index");
@@ -405,6 +544,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int IGraph<T_NodeType, T_ConnectionType>::GetNrOfActiveNodes() const
 	{
+		EnsureBuilt();
+
 		int count = 0;
 
 		for (unsigned int n = 0; n < m_Nodes.size(); ++n) 
@@ -417,6 +558,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int IGraph<T_NodeType, T_ConnectionType>::GetNrOfConnections() const
 	{
+		EnsureBuilt();
+
 		int tot = 0;
 
 		for (auto curEdge = m_Connections.begin();
@@ -432,6 +575,9 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::Clear()
 	{
+		// Whatever was waiting to be built is dropped with the rest
+		m_IsBuildDeferred = false;
+
 		for (auto& n : m_Nodes)
 			SAFE_DELETE(n);
 		m_Nodes.clear();
@@ -444,13 +590,365 @@ namespace Elite
 		m_Connections.clear();
 
 		m_NextNodeIndex = 0;
+		InvalidateComponents();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnections()
 	{
+		EnsureBuilt();
+
 		for (auto& connectionList : m_Connections)
 			connectionList.clear();
+
+		InvalidateComponents();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::vector<int> IGraph<T_NodeType, T_ConnectionType>::Compact()
+	{
+		EnsureBuilt();
+
+		std::vector<int> remap(m_Nodes.size(), invalid_node_index);
+
+		// 1. Assign every active node its new, dense index
+		int nrOfActiveNodes = 0;
+		for (size_t oldIdx = 0; oldIdx < m_Nodes.size(); ++oldIdx)
+		{
+			if (m_Nodes[oldIdx]->GetIndex() != invalid_node_index)
+				remap[oldIdx] = nrOfActiveNodes++;
+		}
+
+		// Nothing was removed, indices are already dense
+		if (nrOfActiveNodes == (int)m_Nodes.size())
+			return remap;
+
+		// 2. Move the nodes and their connection lists to their new slot, deleting the removed ones
+		//    New indices are never larger than the old ones, so this can be done in place
+		for (size_t oldIdx = 0; oldIdx < m_Nodes.size(); ++oldIdx)
+		{
+			int newIdx = remap[oldIdx];
+			if (newIdx == invalid_node_index)
+			{
+				SAFE_DELETE(m_Nodes[oldIdx]);
+				for (auto& connection : m_Connections[oldIdx])
+					SAFE_DELETE(connection);
+				m_Connections[oldIdx].clear();
+				continue;
+			}
+
+			m_Nodes[newIdx] = m_Nodes[oldIdx];
+			m_Nodes[newIdx]->SetIndex(newIdx);
+			if (newIdx != (int)oldIdx)
+				m_Connections[newIdx] = std::move(m_Connections[oldIdx]);
+		}
+
+		m_Nodes.resize(nrOfActiveNodes);
+		m_Connections.resize(nrOfActiveNodes);
+
+		// 3. Renumber the connections, dropping any that still pointed to a removed node
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto it = connectionList.begin(); it != connectionList.end();)
+			{
+				int newTo = remap[(*it)->GetTo()];
+				if (newTo == invalid_node_index)
+				{
+					delete *it;
+					it = connectionList.erase(it);
+					continue;
+				}
+
+				(*it)->SetFrom(remap[(*it)->GetFrom()]);
+				(*it)->SetTo(newTo);
+				++it;
+			}
+		}
+
+		m_NextNodeIndex = nrOfActiveNodes;
+		InvalidateComponents();
+
+		OnGraphModified(true, true);
+		return remap;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool IGraph<T_NodeType, T_ConnectionType>::AreConnected(int from, int to) const
+	{
+		EnsureBuilt();
+
+		// Removed nodes all share the invalid label, they aren't connected to anything
+		auto isActive = [this](int idx) { return idx >= 0 && idx < (int)m_Nodes.size() && m_Nodes[idx]->GetIndex() != invalid_node_index; };
+		if (!isActive(from) || !isActive(to))
+			return false;
+
+		if (m_AreComponentsDirty)
+			RebuildComponents();
+
+		return m_ComponentLabels[from] == m_ComponentLabels[to];
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int IGraph<T_NodeType, T_ConnectionType>::GetComponentLabel(int idx) const
+	{
+		EnsureBuilt();
+
+		assert((idx < (int)m_Nodes.size()) && (idx >= 0) && "<Graph::GetComponentLabel>: invalid index");
+
+		if (m_AreComponentsDirty)
+			RebuildComponents();
+
+		return m_ComponentLabels[idx];
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::RebuildComponents() const
+	{
+		// Union-find over all connections, ignoring their direction
+		std::vector<int> parents(m_Nodes.size());
+		std::iota(parents.begin(), parents.end(), 0);
+
+		auto findRoot = [&parents](int idx)
+		{
+			while (parents[idx] != idx)
+			{
+				parents[idx] = parents[parents[idx]];
+				idx = parents[idx];
+			}
+			return idx;
+		};
+
+		for (const auto& connectionList : m_Connections)
+		{
+			for (auto pConnection : connectionList)
+			{
+				if (m_Nodes[pConnection->GetFrom()]->GetIndex() == invalid_node_index || m_Nodes[pConnection->GetTo()]->GetIndex() == invalid_node_index)
+					continue;
+
+				parents[findRoot(pConnection->GetFrom())] = findRoot(pConnection->GetTo());
+			}
+		}
+
+		// One label per root
+		std::vector<int> rootLabels(m_Nodes.size(), invalid_node_index);
+		m_ComponentLabels.assign(m_Nodes.size(), invalid_node_index);
+		m_ComponentSizes.clear();
+
+		for (int idx = 0; idx < (int)m_Nodes.size(); ++idx)
+		{
+			if (m_Nodes[idx]->GetIndex() == invalid_node_index)
+				continue;
+
+			int& rootLabel = rootLabels[findRoot(idx)];
+			if (rootLabel == invalid_node_index)
+			{
+				rootLabel = (int)m_ComponentSizes.size();
+				m_ComponentSizes.push_back(0);
+			}
+
+			m_ComponentLabels[idx] = rootLabel;
+			++m_ComponentSizes[rootLabel];
+		}
+
+		m_AreComponentsDirty = false;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::AddComponent(int idx)
+	{
+		if (m_AreComponentsDirty)
+			return;
+
+		if (idx >= (int)m_ComponentLabels.size())
+			m_ComponentLabels.resize(idx + 1, invalid_node_index);
+
+		m_ComponentLabels[idx] = (int)m_ComponentSizes.size();
+		m_ComponentSizes.push_back(1);
+		LimitComponentLabels();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::MergeComponents(int a, int b)
+	{
+		if (m_AreComponentsDirty)
+			return;
+
+		// Without incoming connections the nodes of a weak component can't be enumerated, rebuild instead
+		if (m_IsDirectionalGraph)
+		{
+			InvalidateComponents();
+			return;
+		}
+
+		int labelA = m_ComponentLabels[a];
+		int labelB = m_ComponentLabels[b];
+		if (labelA == labelB)
+			return;
+
+		// Relabel the smaller component only
+		if (m_ComponentSizes[labelA] > m_ComponentSizes[labelB])
+		{
+			std::swap(a, b);
+			std::swap(labelA, labelB);
+		}
+
+		std::vector<int> openList{ a };
+		m_ComponentLabels[a] = labelB;
+		while (!openList.empty())
+		{
+			int idx = openList.back();
+			openList.pop_back();
+
+			for (auto pConnection : m_Connections[idx])
+			{
+				if (m_ComponentLabels[pConnection->GetTo()] == labelA)
+				{
+					m_ComponentLabels[pConnection->GetTo()] = labelB;
+					openList.push_back(pConnection->GetTo());
+				}
+			}
+		}
+
+		m_ComponentSizes[labelB] += m_ComponentSizes[labelA];
+		m_ComponentSizes[labelA] = 0;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::SplitComponent(std::vector<int> seeds)
+	{
+		if (m_AreComponentsDirty)
+			return;
+
+		if (m_IsDirectionalGraph)
+		{
+			InvalidateComponents();
+			return;
+		}
+
+		// The seeds were one component before a removal, search from all of them at once, one node per search per round
+		// Searches that meet belong together, a group of searches that runs out of nodes has been cut off and gets a new label
+		// Stops as soon as one group is left, so the cost depends on the pieces that split off, not on the whole component
+		std::sort(seeds.begin(), seeds.end());
+		seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+		seeds.erase(std::remove_if(seeds.begin(), seeds.end(), [this](int idx) { return !IsNodeValid(idx) || m_Nodes[idx]->GetIndex() == invalid_node_index; }), seeds.end());
+		if (seeds.size() < 2)
+			return;
+
+		struct Search
+		{
+			std::queue<int> openList;
+			std::vector<int> visited;
+			int group;
+			bool isFinished;
+		};
+
+		std::vector<Search> searches(seeds.size());
+		std::unordered_map<int, int> visitedBy{};
+		for (size_t s = 0; s < seeds.size(); ++s)
+		{
+			searches[s].openList.push(seeds[s]);
+			searches[s].visited.push_back(seeds[s]);
+			searches[s].group = (int)s;
+			searches[s].isFinished = false;
+			visitedBy[seeds[s]] = (int)s;
+		}
+
+		auto findGroup = [&searches](int s)
+		{
+			while (searches[s].group != s)
+				s = searches[s].group;
+			return s;
+		};
+
+		const int oldLabel = m_ComponentLabels[seeds[0]];
+		int nrOfOpenGroups = (int)seeds.size();
+		while (nrOfOpenGroups > 1)
+		{
+			for (size_t s = 0; s < searches.size(); ++s)
+			{
+				if (searches[s].openList.empty())
+					continue;
+
+				int idx = searches[s].openList.front();
+				searches[s].openList.pop();
+
+				for (auto pConnection : m_Connections[idx])
+				{
+					int neighborIdx = pConnection->GetTo();
+					auto foundIt = visitedBy.find(neighborIdx);
+					if (foundIt == visitedBy.end())
+					{
+						visitedBy[neighborIdx] = (int)s;
+						searches[s].openList.push(neighborIdx);
+						searches[s].visited.push_back(neighborIdx);
+					}
+					else if (findGroup(foundIt->second) != findGroup((int)s))
+					{
+						searches[findGroup(foundIt->second)].group = findGroup((int)s);
+						--nrOfOpenGroups;
+					}
+				}
+			}
+
+			// Groups that ran out of nodes are complete components
+			for (size_t g = 0; g < searches.size(); ++g)
+			{
+				if (findGroup((int)g) != (int)g || searches[g].isFinished)
+					continue;
+
+				bool isExhausted = true;
+				for (size_t s = 0; s < searches.size() && isExhausted; ++s)
+					isExhausted = findGroup((int)s) != (int)g || searches[s].openList.empty();
+
+				if (!isExhausted)
+					continue;
+
+				searches[g].isFinished = true;
+				--nrOfOpenGroups;
+
+				const int newLabel = (int)m_ComponentSizes.size();
+				m_ComponentSizes.push_back(0);
+				for (size_t s = 0; s < searches.size(); ++s)
+				{
+					if (findGroup((int)s) != (int)g)
+						continue;
+
+					for (int idx : searches[s].visited)
+						m_ComponentLabels[idx] = newLabel;
+					m_ComponentSizes[newLabel] += (int)searches[s].visited.size();
+				}
+				m_ComponentSizes[oldLabel] -= m_ComponentSizes[newLabel];
+			}
+		}
+
+		LimitComponentLabels();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::LimitComponentLabels()
+	{
+		// Every split or isolated node takes a new label and merged ones are left empty, so over a long editing session
+		// the labels outgrow the nodes. Past twice the node count the next query renumbers them densely.
+		if (m_ComponentSizes.size() > 2 * m_Nodes.size() + 16)
+			InvalidateComponents();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::EnsureBuilt() const
+	{
+		if (!m_IsBuildDeferred.load(std::memory_order_acquire))
+			return;
+
+		// Other threads wait here until the build is done, the building thread itself gets through (it adds the nodes
+		// and connections with the functions that call EnsureBuilt)
+		std::lock_guard<std::recursive_mutex> lock{ m_DeferredBuildMutex };
+		if (!m_IsBuildDeferred || m_IsBuildingDeferred)
+			return;
+
+		m_IsBuildingDeferred = true;
+		const_cast<IGraph*>(this)->BuildDeferred();
+		m_IsBuildingDeferred = false;
+		m_IsBuildDeferred.store(false, std::memory_order_release);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -462,6 +960,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline bool IGraph<T_NodeType, T_ConnectionType>::IsUniqueConnection(int from, int to) const
 	{
+		EnsureBuilt();
+
 		for(auto c : m_Connections[from])
 		{
 			if (c->GetTo() == to)
@@ -10,7 +10,7 @@ namespace Elite
 	{
 	public:
 		InfluenceMap(bool isDirectional): T_GraphType(isDirectional) {}
-		void InitializeBuffer() { m_InfluenceDoubleBuffer = vector<float>(m_Nodes.size()); }
+		void InitializeBuffer() { m_InfluenceDoubleBuffer = vector<float>(GetNrOfNodes()); }
 		void PropagateInfluence(float deltaTime);
 
 		void SetInfluenceAtPosition(Elite::Vector2 pos, float influence);
@@ -59,7 +59,7 @@ namespace Elite
 		m_TimeSinceLastPropagation = 0.f;
 
 		float highestInfluence{ 0.f };
-		for (auto pNode : m_Nodes)
+		for (auto pNode : GetActiveNodes())
 		{
 			for (auto pConnection : m_Connections[pNode->GetIndex()])
 			{
@@ -75,7 +75,7 @@ namespace Elite
 			highestInfluence = 0.f;
 		}
 
-		for (auto pNode : GetAllNodes())
+		for (auto pNode : GetActiveNodes())
 		{
 			pNode->SetInfluence(m_InfluenceDoubleBuffer[pNode->GetIndex()]);
 		}
@@ -94,7 +94,7 @@ namespace Elite
 	{
 		const float half = .5f;
 
-		for (auto& pNode : m_Nodes)
+		for (auto& pNode : GetAllNodes())
 		{
 			Color nodeColor{};
 			float influence = pNode->GetInfluence();
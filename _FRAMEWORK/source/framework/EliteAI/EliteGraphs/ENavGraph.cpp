@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "ENavGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteAI\EliteGraphs\EGraphFileFormat.h"
+#include "framework\EliteHelpers\EMemoryMappedFile.h"
 
 using namespace Elite;
 
@@ -28,6 +30,12 @@ Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f)
 	CreateNavigationGraph();
 }
 
+Elite::NavGraph::NavGraph() :
+	Graph2D(false),
+	m_pNavMeshPolygon(nullptr)
+{
+}
+
 Elite::NavGraph::~NavGraph()
 {
 	delete m_pNavMeshPolygon; 
@@ -112,3 +120,195 @@ void Elite::NavGraph::CreateNavigationGraph()
 	SetConnectionCostsToDistance();
 }
 
+bool Elite::NavGraph::SaveToFile(const std::string& filePath) const
+{
+	using namespace GraphFileFormat;
+
+	//1. Flatten the polygon: outer shape first, then every child shape
+	std::vector<PolygonChild> children{};
+	std::vector<Point> points{};
+	for (const Vector2& p : m_pNavMeshPolygon->GetPoints())
+		points.push_back({ p.x, p.y });
+
+	for (const Polygon& child : m_pNavMeshPolygon->GetChildren())
+	{
+		children.push_back({ uint32_t(child.GetPoints().size()) });
+		for (const Vector2& p : child.GetPoints())
+			points.push_back({ p.x, p.y });
+	}
+
+	//2. Triangulation
+	std::vector<TriangleRecord> triangles{};
+	for (const Triangle* pTriangle : m_pNavMeshPolygon->GetTriangles())
+	{
+		TriangleRecord record{};
+		record.points[0] = { pTriangle->p1.x, pTriangle->p1.y };
+		record.points[1] = { pTriangle->p2.x, pTriangle->p2.y };
+		record.points[2] = { pTriangle->p3.x, pTriangle->p3.y };
+		for (int i = 0; i < 3; ++i)
+			record.lineIndices[i] = pTriangle->metaData.IndexLines[i];
+		triangles.push_back(record);
+	}
+
+	std::vector<LineRecord> lines{};
+	for (const Line* pLine : m_pNavMeshPolygon->GetLines())
+		lines.push_back({ { pLine->p1.x, pLine->p1.y }, { pLine->p2.x, pLine->p2.y }, pLine->index });
+
+	//3. Graph, nodes are stored by index so removed nodes are not supported
+	std::vector<NodeRecord> nodes{};
+	std::vector<ConnectionRecord> connections{};
+	for (const NavGraphNode* pNode : m_Nodes)
+	{
+		if (pNode->GetIndex() != int(nodes.size()))
+			return false;
+
+		nodes.push_back({ pNode->GetLineIndex(), { pNode->GetPosition().x, pNode->GetPosition().y } });
+		for (const GraphConnection2D* pConnection : m_Connections[pNode->GetIndex()])
+			connections.push_back({ pConnection->GetFrom(), pConnection->GetTo(), pConnection->GetCost() });
+	}
+
+	std::ofstream file{ filePath, std::ios::binary };
+	if (!file)
+		return false;
+
+	NavGraphHeader header{};
+	header.magic = NavGraphMagic;
+	header.version = NavGraphVersion;
+	header.nrOfOuterPoints = uint32_t(m_pNavMeshPolygon->GetPoints().size());
+	header.nrOfChildren = uint32_t(children.size());
+	header.nrOfPoints = uint32_t(points.size());
+	header.nrOfTriangles = uint32_t(triangles.size());
+	header.nrOfLines = uint32_t(lines.size());
+	header.nrOfNodes = uint32_t(nodes.size());
+	header.nrOfConnections = uint32_t(connections.size());
+
+	// All records are 4 byte aligned, so every block stays aligned without padding
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(children.data()), children.size() * sizeof(PolygonChild));
+	file.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(Point));
+	file.write(reinterpret_cast<const char*>(triangles.data()), triangles.size() * sizeof(TriangleRecord));
+	file.write(reinterpret_cast<const char*>(lines.data()), lines.size() * sizeof(LineRecord));
+	file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(NodeRecord));
+	file.write(reinterpret_cast<const char*>(connections.data()), connections.size() * sizeof(ConnectionRecord));
+
+	return file.good();
+}
+
+Elite::NavGraph* Elite::NavGraph::LoadFromFile(const std::string& filePath)
+{
+	using namespace GraphFileFormat;
+
+	MemoryMappedFile file{ filePath };
+
+	//1. Locate every block, the records are used straight from the mapped file
+	const NavGraphHeader* pHeader = file.GetAt<NavGraphHeader>(0);
+	if (pHeader == nullptr
+		|| pHeader->magic != NavGraphMagic
+		|| pHeader->version != NavGraphVersion
+		|| pHeader->nrOfOuterPoints > pHeader->nrOfPoints)
+		return nullptr;
+
+	// 64-bit offsets, a 32-bit count times a record size can't overflow them (GetAt rejects what is past the end)
+	uint64_t offset = sizeof(NavGraphHeader);
+	const PolygonChild* pChildren = file.GetAt<PolygonChild>(offset, pHeader->nrOfChildren);
+	offset += uint64_t(pHeader->nrOfChildren) * sizeof(PolygonChild);
+	const Point* pPoints = file.GetAt<Point>(offset, pHeader->nrOfPoints);
+	offset += uint64_t(pHeader->nrOfPoints) * sizeof(Point);
+	const TriangleRecord* pTriangles = file.GetAt<TriangleRecord>(offset, pHeader->nrOfTriangles);
+	offset += uint64_t(pHeader->nrOfTriangles) * sizeof(TriangleRecord);
+	const LineRecord* pLines = file.GetAt<LineRecord>(offset, pHeader->nrOfLines);
+	offset += uint64_t(pHeader->nrOfLines) * sizeof(LineRecord);
+	const NodeRecord* pNodes = file.GetAt<NodeRecord>(offset, pHeader->nrOfNodes);
+	offset += uint64_t(pHeader->nrOfNodes) * sizeof(NodeRecord);
+	const ConnectionRecord* pConnections = file.GetAt<ConnectionRecord>(offset, pHeader->nrOfConnections);
+
+	if (!pChildren || !pPoints || !pTriangles || !pLines || !pNodes || !pConnections)
+		return nullptr;
+
+	//2. Check every index before anything is built, none of them is checked again once the navmesh is in use
+	// Lines are looked up by their position in the line block (triangle metadata, a node's line, path smoothing)
+	auto isLineIdx = [pHeader](int32_t idx) { return idx >= 0 && uint32_t(idx) < pHeader->nrOfLines; };
+	auto isNodeIdx = [pHeader](int32_t idx) { return idx >= 0 && uint32_t(idx) < pHeader->nrOfNodes; };
+
+	uint64_t nrOfChildPoints = 0;
+	for (uint32_t c = 0; c < pHeader->nrOfChildren; ++c)
+		nrOfChildPoints += pChildren[c].nrOfPoints;
+	if (nrOfChildPoints > pHeader->nrOfPoints - pHeader->nrOfOuterPoints)
+		return nullptr;
+
+	for (uint32_t i = 0; i < pHeader->nrOfTriangles; ++i)
+	{
+		const int32_t* pLineIndices = pTriangles[i].lineIndices;
+		if (!isLineIdx(pLineIndices[0]) || !isLineIdx(pLineIndices[1]) || !isLineIdx(pLineIndices[2]))
+			return nullptr;
+	}
+
+	for (uint32_t i = 0; i < pHeader->nrOfLines; ++i)
+	{
+		if (pLines[i].index != int32_t(i))
+			return nullptr;
+	}
+
+	for (uint32_t i = 0; i < pHeader->nrOfNodes; ++i)
+	{
+		if (!isLineIdx(pNodes[i].lineIndex))
+			return nullptr;
+	}
+
+	for (uint32_t i = 0; i < pHeader->nrOfConnections; ++i)
+	{
+		const ConnectionRecord& record = pConnections[i];
+		if (!isNodeIdx(record.from) || !isNodeIdx(record.to) || record.from == record.to)
+			return nullptr;
+	}
+
+	//3. Polygon and its triangulation
+	auto toVector2 = [](const Point& p) { return Vector2{ p.x, p.y }; };
+
+	std::vector<Vector2> outerShape{};
+	outerShape.reserve(pHeader->nrOfOuterPoints);
+	for (uint32_t i = 0; i < pHeader->nrOfOuterPoints; ++i)
+		outerShape.push_back(toVector2(pPoints[i]));
+
+	std::vector<std::vector<Vector2>> innerShapes(pHeader->nrOfChildren);
+	uint32_t pointIdx = pHeader->nrOfOuterPoints;
+	for (uint32_t c = 0; c < pHeader->nrOfChildren; ++c)
+	{
+		for (uint32_t i = 0; i < pChildren[c].nrOfPoints; ++i)
+			innerShapes[c].push_back(toVector2(pPoints[pointIdx++]));
+	}
+
+	std::vector<Triangle*> triangles{};
+	triangles.reserve(pHeader->nrOfTriangles);
+	for (uint32_t i = 0; i < pHeader->nrOfTriangles; ++i)
+	{
+		const TriangleRecord& record = pTriangles[i];
+		Triangle* pTriangle = new Triangle(toVector2(record.points[0]), toVector2(record.points[1]), toVector2(record.points[2]));
+		for (int l = 0; l < 3; ++l)
+			pTriangle->metaData.IndexLines[l] = record.lineIndices[l];
+		triangles.push_back(pTriangle);
+	}
+
+	std::vector<Line*> lines{};
+	lines.reserve(pHeader->nrOfLines);
+	for (uint32_t i = 0; i < pHeader->nrOfLines; ++i)
+		lines.push_back(new Line(toVector2(pLines[i].p1), toVector2(pLines[i].p2), pLines[i].index));
+
+	NavGraph* pNavGraph = new NavGraph();
+	pNavGraph->m_pNavMeshPolygon = new Polygon(outerShape, innerShapes);
+	pNavGraph->m_pNavMeshPolygon->SetTriangulation(triangles, lines);
+
+	//4. Graph, the connections are stored in both directions already so they are added to the lists directly
+	for (uint32_t i = 0; i < pHeader->nrOfNodes; ++i)
+		pNavGraph->AddNode(new NavGraphNode(int(i), pNodes[i].lineIndex, toVector2(pNodes[i].position)));
+
+	for (uint32_t i = 0; i < pHeader->nrOfConnections; ++i)
+	{
+		const ConnectionRecord& record = pConnections[i];
+		pNavGraph->m_Connections[record.from].push_back(new GraphConnection2D(record.from, record.to, record.cost));
+	}
+
+	pNavGraph->InvalidateComponents();
+	pNavGraph->OnGraphModified(true, true);
+	return pNavGraph;
+}
@@ -15,7 +15,15 @@ namespace Elite
 		int GetNodeIdxFromLineIdx(int lineIdx) const;
 		Polygon* GetNavMeshPolygon() const;
 
+		// Baked navmesh (see EGraphFileFormat.h): the triangulated polygon and the graph built on it
+		// Loading needs no physics world and no triangulation, it returns nullptr if the file can't be used (another
+		// version, truncated, or a triangle, line, node or connection index out of range)
+		bool SaveToFile(const std::string& filePath) const;
+		static NavGraph* LoadFromFile(const std::string& filePath);
+
 	private:
+		NavGraph();
+
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
 
@@ -1,179 +1,533 @@
 #pragma once
 #include <assert.h>
+#include <limits>
+#include <map>
+#include <queue>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include "EBucketQueue.h"
+#include "EGoalBounding.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphViews.h"
 
 namespace Elite
 {
-	template <class T_NodeType, class T_ConnectionType>
-	class AStar
+	// Per node state of an AStarSearch
+	template <class T_CostType>
+	struct SearchRecord
+	{
+		T_CostType gCost = std::numeric_limits<T_CostType>::max();
+		int parentIdx = invalid_node_index;
+		float stepCost = 0.f; // of the connection from the parent
+		bool isClosed = false;
+	};
+
+	// Search state in arrays the size of the graph, for searches that cover a good part of it
+	template <class T_CostType>
+	class DenseSearchRecords
 	{
 	public:
-		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		void Reset(int nrOfNodes) { m_Records.assign(nrOfNodes, {}); }
+		SearchRecord<T_CostType>& Get(int idx) { return m_Records[idx]; }
+		const SearchRecord<T_CostType>& Get(int idx) const { return m_Records[idx]; }
+		bool IsClosed(int idx) const { return m_Records[idx].isClosed; }
 
-		// stores the optimal connection to a node and its total costs related to the start and end node of the path
-		struct NodeRecord
+	private:
+		std::vector<SearchRecord<T_CostType>> m_Records;
+	};
+
+	// Search state hashed on node index, only the nodes a search reaches take memory
+	// For local searches, or many searches in flight on a big graph
+	template <class T_CostType>
+	class HashedSearchRecords
+	{
+	public:
+		void Reset(int) { m_Records.clear(); }
+		SearchRecord<T_CostType>& Get(int idx) { return m_Records[idx]; }
+		const SearchRecord<T_CostType>& Get(int idx) const { return m_Records.at(idx); }
+		bool IsClosed(int idx) const
 		{
-			T_NodeType* pNode = nullptr;
-			T_ConnectionType* pConnection = nullptr; // connection from previous node to current pNode
-			float gCost = 0.f; // cost so far = accumulated g-costs of all the connections leading up to this one
-			float fCost = 0.f; // estimatedTotalCost (= costSoFar + h-cost)
+			auto it = m_Records.find(idx);
+			return it != m_Records.end() && it->second.isClosed;
+		}
 
-			bool operator==(const NodeRecord& other) const
-			{
-				return pNode == other.pNode
-					&& pConnection == other.pConnection
-					&& AreEqual(gCost, other.gCost)
-					&& AreEqual(fCost, other.fCost);
-			};
+	private:
+		std::unordered_map<int, SearchRecord<T_CostType>> m_Records;
+	};
 
-			bool operator<(const NodeRecord& other) const
-			{
-				return fCost < other.fCost;
-			};
+	// The A* loop every search over a graph view (see EGraphViews.h) runs on: AStar, PathScheduler, PathRepair,
+	// SubgoalGraph and MultiTargetDijkstra. Start sets a search up, Expand runs it for a number of expansions at a time,
+	// so it can be spread over frames, until a goal is closed or the open list runs out.
+	// Goals are a predicate, so a search can stop at the first of many targets. The heuristic aims at one node, a
+	// heuristic of 0 turns the search into Dijkstra. A cheaper path reopens a closed node.
+	// With an integral T_CostType costs are fixed point, integer multiples of 1 / FixedPointScale, and the open list is
+	// a bucket queue. T_Records picks dense or hashed node state, T_Heuristic is anything called as h(dx, dy).
+	template <class T_GraphView, class T_CostType = float, class T_Records = DenseSearchRecords<T_CostType>, class T_Heuristic = Heuristic>
+	class AStarSearch
+	{
+	public:
+		AStarSearch(const T_GraphView* pGraph, T_Heuristic hFunction);
+
+		static constexpr float FixedPointScale = 2.f;
+
+		// See AStar::SetSearchMode
+		void SetSearchMode(SearchMode mode, float suboptimalityBound = 0.f);
+		// Nodes further than maxCost from the start aren't reached
+		void SetMaxCost(float maxCost) { m_MaxCost = maxCost; }
+
+		// The heuristic estimates the cost to aimIdx
+		void Start(int startIdx, int aimIdx);
+		// Expands at most maxExpansions nodes, returns true once the search is done
+		// isGoal(idx) ends the search when idx is closed, connections for which isEdgeUseful(fromIdx, toIdx) is false are skipped
+		template <class T_IsGoal, class T_IsEdgeUseful>
+		bool Expand(int maxExpansions, T_IsGoal&& isGoal, T_IsEdgeUseful&& isEdgeUseful);
+		template <class T_IsGoal>
+		bool Expand(int maxExpansions, T_IsGoal&& isGoal) { return Expand(maxExpansions, isGoal, [](int, int) { return true; }); }
+
+		bool IsDone() const { return m_IsDone; }
+		// Goal the search ended on, invalid_node_index while it runs or when it found none
+		int GetFoundIdx() const { return m_FoundIdx; }
+		// Node indices from the start to the found goal (empty without one), pPathCost gets the sum of its connection costs
+		std::vector<int> GetPath(float* pPathCost = nullptr) const;
+
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+		int GetNrOfGeneratedNodes() const { return m_NrOfGeneratedNodes; } // entries added to the open list
+
+	private:
+		static constexpr bool IsFixedPoint = std::is_integral<T_CostType>::value;
+
+		struct OpenEntry
+		{
+			T_CostType fCost;
+			T_CostType gCost;
+			int idx;
+
+			// Ties on f go to the deeper entry, it is closer to the goal
+			bool operator>(const OpenEntry& other) const { return fCost > other.fCost || (fCost == other.fCost && gCost < other.gCost); }
+		};
+
+		// Focal only: entries within the bound of the lowest f, ordered on h
+		struct FocalEntry
+		{
+			T_CostType hCost;
+			OpenEntry entry;
+
+			bool operator>(const FocalEntry& other) const { return hCost > other.hCost; }
+		};
+
+		T_CostType ToCost(float cost) const;
+		float FromCost(T_CostType cost) const { return IsFixedPoint ? float(cost) / FixedPointScale : float(cost); }
+		T_CostType GetHeuristicCost(int idx) const;
+
+		// A node can be in the open list more than once, only the entry with its current g cost counts
+		bool IsOutdated(const OpenEntry& entry) const
+		{
+			const SearchRecord<T_CostType>& record = m_Records.Get(entry.idx);
+			return record.isClosed || entry.gCost != record.gCost;
+		}
+		void PushOpen(const OpenEntry& entry);
+		bool PopOpen(OpenEntry& entry);
+		void PushQueue(const OpenEntry& entry);
+		OpenEntry PopQueue();
+		bool IsQueueEmpty() const { return IsFixedPoint ? m_BucketQueue.IsEmpty() : m_Heap.empty(); }
+		T_CostType GetQueueMinF();
+		void RemoveOpenF(T_CostType fCost);
+
+		const T_GraphView* m_pGraph;
+		T_Heuristic m_HeuristicFunction;
+		SearchMode m_SearchMode = SearchMode::Optimal;
+		float m_SuboptimalityBound = 0.f;
+		float m_MaxCost = std::numeric_limits<float>::max();
+
+		T_Records m_Records;
+		BucketQueue<OpenEntry> m_BucketQueue; // fixed point
+		std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> m_Heap; // float
+		std::priority_queue<FocalEntry, std::vector<FocalEntry>, std::greater<FocalEntry>> m_FocalList;
+		std::map<T_CostType, int> m_NrOfOpenNodesPerF; // focal only, its first key is the lowest f in either list
+
+		Vector2 m_AimPos{};
+		int m_StartIdx = invalid_node_index;
+		int m_FoundIdx = invalid_node_index;
+		bool m_IsDone = true;
+		int m_NrOfExpandedNodes = 0;
+		int m_NrOfGeneratedNodes = 0;
+	};
+
+	// A* from one node to another over a graph view, with the search modes, fixed point costs, goal bounding and stats
+	// The agent size is the view's, e.g. IGraphView{ pGraph, agentSize }. Views over an IGraph (IGraphView, GridGraphView)
+	// also take and return node pointers, views that offer CanReach reject unreachable goals without flooding the component.
+	template <class T_GraphView>
+	class AStar
+	{
+	public:
+		AStar(const T_GraphView* pGraph, Heuristic hFunction);
+
+		std::vector<int> FindPath(int startIdx, int goalIdx);
+		template <class T_NodeType>
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) { return ToNodes(FindPath(pStartNode->GetIndex(), pGoalNode->GetIndex()), pStartNode); }
+
+		// Fixed point version, e.g. FindPath<uint32_t>(pStart, pGoal): costs are stored as integer multiples of 1 / FixedPointScale
+		// and the open list is a bucket queue with O(1) push and pop. Gives paths of the same cost as the float version
+		// as long as all connection costs are multiples of 1 / FixedPointScale (grid costs are multiples of 0.5).
+		template <class T_CostType>
+		std::vector<int> FindPath(int startIdx, int goalIdx);
+		template <class T_CostType, class T_NodeType>
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) { return ToNodes(FindPath<T_CostType>(pStartNode->GetIndex(), pGoalNode->GetIndex()), pStartNode); }
+
+		static constexpr float FixedPointScale = 2.f;
+
+		// Bounded suboptimal modes, returned paths cost at most (1 + suboptimalityBound) times the optimal cost
+		// (with an admissible heuristic). WeightedAStar inflates the heuristic, Focal expands the node closest to the
+		// goal among those whose f is within the bound of the lowest f.
+		void SetSearchMode(SearchMode mode, float suboptimalityBound = 0.f);
+		SearchMode GetSearchMode() const { return m_SearchMode; }
+
+		// Instrumentation of the last FindPath call
+		struct SearchStats
+		{
+			int nrOfExpandedNodes = 0;
+			int nrOfGeneratedNodes = 0; // records added to the open list
+			float pathCost = 0.f; // of the returned path
 		};
+		const SearchStats& GetLastSearchStats() const { return m_LastSearchStats; }
 
-		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Edges the goal bounds rule out are skipped, only when the bounds were built for the view's agent size (nullptr turns it off)
+		template <class T_NodeType, class T_ConnectionType>
+		void SetGoalBounding(const GoalBounding<T_NodeType, T_ConnectionType>* pGoalBounding);
 
 	private:
-		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
+		template <class T_CostType>
+		std::vector<int> Search(int startIdx, int goalIdx);
+
+		template <class T_NodeType>
+		std::vector<T_NodeType*> ToNodes(const std::vector<int>& path, T_NodeType*) const
+		{
+			std::vector<T_NodeType*> nodePath{};
+			nodePath.reserve(path.size());
+			for (int idx : path)
+				nodePath.push_back(m_pGraph->GetGraph()->GetNode(idx));
+			return nodePath;
+		}
 
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		const T_GraphView* m_pGraph;
 		Heuristic m_HeuristicFunction;
+
+		SearchMode m_SearchMode = SearchMode::Optimal;
+		float m_SuboptimalityBound = 0.f;
+		SearchStats m_LastSearchStats{};
+		std::function<bool(int, int, int)> m_IsEdgeUseful; // (fromIdx, toIdx, goalIdx), empty without goal bounding
 	};
 
-	template <class T_NodeType, class T_ConnectionType>
-	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+	// A* over a graph view, returns the node indices from start to goal (empty when unreachable)
+	// Optimal with a consistent heuristic (e.g. Octile on grids), the same search as AStar::FindPath
+	template <class T_GraphView>
+	std::vector<int> FindPathAStar(const T_GraphView& graph, int startIdx, int goalIdx, Heuristic hFunction, float* pPathCost = nullptr);
+
+	//--- AStarSearch ---
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::AStarSearch(const T_GraphView* pGraph, T_Heuristic hFunction)
 		: m_pGraph(pGraph)
 		, m_HeuristicFunction(hFunction)
 	{
+		static_assert(IsGraphView_v<T_GraphView>, "<AStarSearch>: T_GraphView doesn't offer the graph view interface");
+		static_assert(std::is_floating_point<T_CostType>::value || std::is_integral<T_CostType>::value, "<AStarSearch>: the cost type has to be a float or an integer type");
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
-	{
-		std::vector<T_NodeType*> path{};
-		std::vector<NodeRecord> openList{};
-		std::vector<NodeRecord> closedList{};
-
-		// 1. Create startRecord and add to open List to start while loop
-		NodeRecord currentRecord{};
-		currentRecord.pNode = pStartNode;
-		currentRecord.pConnection = nullptr;
-		currentRecord.fCost = GetHeuristicCost(pStartNode, pGoalNode);
-
-		openList.push_back(currentRecord);
-		
-		// 2. Continue searching for a connection that leads to the end node
-		while (!openList.empty())
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	void AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::SetSearchMode(SearchMode mode, float suboptimalityBound)
+	{
+		assert(suboptimalityBound >= 0.f && "<AStarSearch::SetSearchMode>: the suboptimality bound can't be negative");
+
+		m_SearchMode = mode;
+		m_SuboptimalityBound = suboptimalityBound;
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	void AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::Start(int startIdx, int aimIdx)
+	{
+		m_Records.Reset(m_pGraph->GetNrOfNodes());
+		m_BucketQueue.Clear();
+		m_Heap = {};
+		m_FocalList = {};
+		m_NrOfOpenNodesPerF.clear();
+
+		m_AimPos = m_pGraph->GetPosition(aimIdx);
+		m_StartIdx = startIdx;
+		m_FoundIdx = invalid_node_index;
+		m_IsDone = false;
+		m_NrOfExpandedNodes = 0;
+		m_NrOfGeneratedNodes = 0;
+
+		m_Records.Get(startIdx).gCost = 0;
+		PushOpen({ GetHeuristicCost(startIdx), 0, startIdx });
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	template <class T_IsGoal, class T_IsEdgeUseful>
+	bool AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::Expand(int maxExpansions, T_IsGoal&& isGoal, T_IsEdgeUseful&& isEdgeUseful)
+	{
+		for (int i = 0; i < maxExpansions && !m_IsDone; ++i)
 		{
-			// 2.a Get the connection with lowest F score
-			currentRecord = openList[0];
-			for (const NodeRecord& recordFromList : openList)
+			// 1. Take the best open node, the search fails when there is none left
+			OpenEntry current{};
+			if (!PopOpen(current))
 			{
-				if (recordFromList.fCost < currentRecord.fCost)
-				{
-					currentRecord = recordFromList;
-				}
+				m_IsDone = true;
+				break;
 			}
 
-			// 2.b Check if that connection leads to the end node
-			if (currentRecord.pNode == pGoalNode)
+			m_Records.Get(current.idx).isClosed = true;
+			++m_NrOfExpandedNodes;
+
+			if (isGoal(current.idx))
 			{
+				m_FoundIdx = current.idx;
+				m_IsDone = true;
 				break;
 			}
 
-			// 2.c Get all the connections of the NodeRecord's node
-			auto connectionList = m_pGraph->GetNodeConnections(currentRecord.pNode->GetIndex());
-			for (const auto& pConnection : connectionList)
-			{
-				// Calculate the total cost so far
-				float gCost = pConnection->GetCost() + currentRecord.gCost;
+			// 2. Open every neighbor this reaches cheaper, closed ones are reopened
+			m_pGraph->ForEachNeighbor(current.idx, [&](int toIdx, float cost)
+				{
+					if (!isEdgeUseful(current.idx, toIdx))
+						return;
 
-				// 2.d Check if any of them lead to a node already on the closed list
-				int getToIdx = pConnection->GetTo();
-				auto pGetToNode = m_pGraph->GetNode(getToIdx);
+					const T_CostType gCost = current.gCost + ToCost(cost);
+					if (FromCost(gCost) > m_MaxCost)
+						return;
 
-				bool isInClosed{ false };
-				for (size_t i{}; i < closedList.size(); ++i)
-				{
-					if (closedList[i].pNode == pGetToNode)
-					{
-						isInClosed = true;
-						if (closedList[i].gCost > gCost)
-						{
-							const vector<NodeRecord>::iterator& it = closedList.begin() + i;
-							closedList.erase(it);
-							break;
-						}
-					}
-				}
-
-				if (isInClosed == true)
-				{
-					continue;
-				}
+					SearchRecord<T_CostType>& toRecord = m_Records.Get(toIdx);
+					if (gCost >= toRecord.gCost)
+						return;
 
-				// 2.e If 2.d check failed, check if any of those connections lead to a node already on the open list
-				bool isInOpen{ false };
-				for (size_t i{}; i < openList.size(); ++i)
-				{
-					if (openList[i].pNode == pGetToNode)
-					{
-						isInOpen = true;
-						if (openList[i].gCost > gCost)
-						{
-							vector<NodeRecord>::iterator it = openList.begin() + i;
-							openList.erase(it);
-						}
-						break;
-					}
-				}
-
-				if (isInOpen == true)
-				{
-					continue;
-				}
-
-				// 2.f At this point any expensive connection should be removed. We create a new nodeRecord and add it to the openList
-				NodeRecord newRecord{};
-				newRecord.pNode = pGetToNode;
-				newRecord.pConnection = pConnection;
-				newRecord.gCost = gCost;
-				newRecord.fCost = gCost + GetHeuristicCost(pGetToNode, pGoalNode);
-				openList.push_back(newRecord);
-			}
+					// A node that was open already moves to its new f
+					const T_CostType hCost = GetHeuristicCost(toIdx);
+					if (m_SearchMode == SearchMode::Focal && toRecord.gCost != std::numeric_limits<T_CostType>::max() && !toRecord.isClosed)
+						RemoveOpenF(toRecord.gCost + hCost);
 
-			// 2.g Remove NodeRecord from the openList and add it to the closedList
-			auto it = std::find(openList.begin(), openList.end(), currentRecord);
-			assert(it != openList.end());
-			openList.erase(it);
-			closedList.push_back(currentRecord);
+					toRecord = { gCost, current.idx, cost, false };
+					PushOpen({ gCost + hCost, gCost, toIdx });
+				});
 		}
+		return m_IsDone;
+	}
 
-		// 3. Reconstruct path from last connection to start node
-		path.push_back(pGoalNode);
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	std::vector<int> AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::GetPath(float* pPathCost) const
+	{
+		std::vector<int> path{};
+		float pathCost = 0.f;
 
-		while (currentRecord.pNode != pStartNode)
+		// Ancestors reopened after the goal got its g cost can make the walked path cheaper than that g cost
+		if (m_FoundIdx != invalid_node_index)
 		{
-			for (size_t i{}; i < closedList.size(); ++i)
+			for (int idx = m_FoundIdx; idx != m_StartIdx; idx = m_Records.Get(idx).parentIdx)
 			{
-				int prevNodeIdx = currentRecord.pConnection->GetFrom();
-				if (closedList[i].pNode == m_pGraph->GetNode(prevNodeIdx))
-				{
-					path.push_back(closedList[i].pNode);
-					currentRecord = closedList[i];
-					break;
-				}
+				pathCost += m_Records.Get(idx).stepCost;
+				path.push_back(idx);
 			}
+			path.push_back(m_StartIdx);
+			std::reverse(path.begin(), path.end());
 		}
 
-		std::reverse(path.begin(), path.end());
+		if (pPathCost)
+			*pPathCost = pathCost;
 		return path;
 	}
 
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	T_CostType AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::ToCost(float cost) const
+	{
+		if (!IsFixedPoint)
+			return T_CostType(cost);
+
+		assert(AreEqual(cost * FixedPointScale, roundf(cost * FixedPointScale)) && "<AStarSearch::ToCost>: cost is not a multiple of 1 / FixedPointScale");
+		return T_CostType(roundf(cost * FixedPointScale));
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	T_CostType AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::GetHeuristicCost(int idx) const
+	{
+		const Vector2 toAim = m_AimPos - m_pGraph->GetPosition(idx);
+		const float weight = m_SearchMode == SearchMode::WeightedAStar ? 1.f + m_SuboptimalityBound : 1.f;
+
+		// Fixed point heuristics are rounded down, so they stay admissible and the suboptimality bound still holds
+		const float hCost = weight * m_HeuristicFunction(abs(toAim.x), abs(toAim.y));
+		return IsFixedPoint ? T_CostType(hCost * FixedPointScale) : T_CostType(hCost);
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	void AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::PushOpen(const OpenEntry& entry)
+	{
+		PushQueue(entry);
+		++m_NrOfGeneratedNodes;
+
+		if (m_SearchMode == SearchMode::Focal)
+			++m_NrOfOpenNodesPerF[entry.fCost];
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	bool AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::PopOpen(OpenEntry& entry)
+	{
+		if (m_SearchMode != SearchMode::Focal)
+		{
+			do
+			{
+				if (IsQueueEmpty())
+					return false;
+				entry = PopQueue();
+			} while (IsOutdated(entry));
+			return true;
+		}
+
+		if (m_NrOfOpenNodesPerF.empty())
+			return false;
+
+		// Everything within the bound of the lowest f moves to the focal list, the node at the lowest f is always among them
+		const T_CostType focalBound = T_CostType(m_NrOfOpenNodesPerF.begin()->first * (1.f + m_SuboptimalityBound));
+		while (!IsQueueEmpty() && GetQueueMinF() <= focalBound)
+		{
+			const OpenEntry candidate = PopQueue();
+			if (!IsOutdated(candidate))
+				m_FocalList.push({ candidate.fCost - candidate.gCost, candidate });
+		}
+
+		// After a reopen the lowest f can drop, entries past the new bound go back to wait in the open list
+		while (true)
+		{
+			entry = m_FocalList.top().entry;
+			m_FocalList.pop();
+			if (IsOutdated(entry))
+				continue;
+			if (entry.fCost <= focalBound)
+				break;
+			PushQueue(entry);
+		}
+
+		RemoveOpenF(entry.fCost);
+		return true;
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	void AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::PushQueue(const OpenEntry& entry)
+	{
+		if constexpr (IsFixedPoint)
+			m_BucketQueue.Push(size_t(entry.fCost), entry);
+		else
+			m_Heap.push(entry);
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	typename AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::OpenEntry AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::PopQueue()
+	{
+		if constexpr (IsFixedPoint)
+		{
+			return m_BucketQueue.Pop();
+		}
+		else
+		{
+			const OpenEntry entry = m_Heap.top();
+			m_Heap.pop();
+			return entry;
+		}
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	T_CostType AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::GetQueueMinF()
+	{
+		if constexpr (IsFixedPoint)
+			return T_CostType(m_BucketQueue.GetMinKey());
+		else
+			return m_Heap.top().fCost;
+	}
+
+	template <class T_GraphView, class T_CostType, class T_Records, class T_Heuristic>
+	void AStarSearch<T_GraphView, T_CostType, T_Records, T_Heuristic>::RemoveOpenF(T_CostType fCost)
+	{
+		auto it = m_NrOfOpenNodesPerF.find(fCost);
+		if (--it->second == 0)
+			m_NrOfOpenNodesPerF.erase(it);
+	}
+
+	//--- AStar ---
+	template <class T_GraphView>
+	AStar<T_GraphView>::AStar(const T_GraphView* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+		static_assert(IsGraphView_v<T_GraphView>, "<AStar>: T_GraphView doesn't offer the graph view interface");
+	}
+
+	template <class T_GraphView>
+	void AStar<T_GraphView>::SetSearchMode(SearchMode mode, float suboptimalityBound)
+	{
+		assert(suboptimalityBound >= 0.f && "<AStar::SetSearchMode>: the suboptimality bound can't be negative");
+
+		m_SearchMode = mode;
+		m_SuboptimalityBound = suboptimalityBound;
+	}
+
+	template <class T_GraphView>
 	template <class T_NodeType, class T_ConnectionType>
-	float Elite::AStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const
+	void AStar<T_GraphView>::SetGoalBounding(const GoalBounding<T_NodeType, T_ConnectionType>* pGoalBounding)
+	{
+		m_IsEdgeUseful = nullptr;
+		if (pGoalBounding != nullptr && pGoalBounding->GetAgentSize() == m_pGraph->GetAgentSize())
+			m_IsEdgeUseful = [pGoalBounding](int fromIdx, int toIdx, int goalIdx) { return pGoalBounding->IsEdgeUseful(fromIdx, toIdx, goalIdx); };
+	}
+
+	template <class T_GraphView>
+	std::vector<int> AStar<T_GraphView>::FindPath(int startIdx, int goalIdx)
+	{
+		return Search<float>(startIdx, goalIdx);
+	}
+
+	template <class T_GraphView>
+	template <class T_CostType>
+	std::vector<int> AStar<T_GraphView>::FindPath(int startIdx, int goalIdx)
 	{
-		Vector2 toDestination = m_pGraph->GetNodePos(pEndNode) - m_pGraph->GetNodePos(pStartNode);
-		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		static_assert(std::is_integral<T_CostType>::value, "AStar::FindPath<T_CostType>: the fixed point cost type has to be an integer type");
+		return Search<T_CostType>(startIdx, goalIdx);
+	}
+
+	template <class T_GraphView>
+	template <class T_CostType>
+	std::vector<int> AStar<T_GraphView>::Search(int startIdx, int goalIdx)
+	{
+		m_LastSearchStats = {};
+
+		// 0. Unreachable goals are rejected without flooding the whole component
+		if constexpr (HasCanReach_v<T_GraphView>)
+		{
+			if (!m_pGraph->CanReach(startIdx, goalIdx))
+				return {};
+		}
+
+		// 1. Search until the goal is closed
+		AStarSearch<T_GraphView, T_CostType> search{ m_pGraph, m_HeuristicFunction };
+		search.SetSearchMode(m_SearchMode, m_SuboptimalityBound);
+		search.Start(startIdx, goalIdx);
+
+		auto isGoal = [goalIdx](int idx) { return idx == goalIdx; };
+		if (m_IsEdgeUseful)
+			search.Expand(std::numeric_limits<int>::max(), isGoal, [&](int fromIdx, int toIdx) { return m_IsEdgeUseful(fromIdx, toIdx, goalIdx); });
+		else
+			search.Expand(std::numeric_limits<int>::max(), isGoal);
+
+		// 2. Walk back from the goal
+		m_LastSearchStats.nrOfExpandedNodes = search.GetNrOfExpandedNodes();
+		m_LastSearchStats.nrOfGeneratedNodes = search.GetNrOfGeneratedNodes();
+		return search.GetPath(&m_LastSearchStats.pathCost);
+	}
+
+	template <class T_GraphView>
+	std::vector<int> FindPathAStar(const T_GraphView& graph, int startIdx, int goalIdx, Heuristic hFunction, float* pPathCost)
+	{
+		AStar<T_GraphView> pathfinder{ &graph, hFunction };
+		std::vector<int> path = pathfinder.FindPath(startIdx, goalIdx);
+
+		if (pPathCost)
+			*pPathCost = pathfinder.GetLastSearchStats().pathCost;
+		return path;
 	}
-}
\ No newline at end of file
+}
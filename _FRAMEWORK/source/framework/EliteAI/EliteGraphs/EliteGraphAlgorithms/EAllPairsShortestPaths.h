@@ -0,0 +1,210 @@
+#pragma once
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include "framework\EliteHelpers\ESpinBarrier.h"
+
+namespace Elite
+{
+	// Distance and next hop between every pair of nodes, for small graphs that are queried a lot (waypoint graphs, influence graphs)
+	// Build runs a blocked Floyd-Warshall: the n x n matrices are cut in BlockSize x BlockSize tiles and every round of k
+	// updates the diagonal tile first, then the tiles in its row and column, then all the others. The tiles of a phase are
+	// independent, so they are spread over threads, and a tile fits in cache so each pass over it reuses what is loaded.
+	// Distances are an O(1) lookup, a path is followed hop by hop in O(length). Memory is 8 bytes per pair, so keep it
+	// to graphs of a few thousand nodes. Build has to be redone after the graph (or a connection cost) changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class AllPairsShortestPaths
+	{
+	public:
+		static constexpr int BlockSize = 64;
+
+		AllPairsShortestPaths(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// nrOfThreads = 0 uses all cores, removed nodes can't be reached
+		void Build(unsigned int nrOfThreads = 0);
+		bool IsBuilt() const { return !m_Distances.empty(); }
+		double GetLastBuildSeconds() const { return m_LastBuildSeconds; }
+
+		// Float max when toIdx can't be reached
+		float GetDistance(int fromIdx, int toIdx) const;
+		// First node after fromIdx on a shortest path, fromIdx itself when both are the same, invalid_node_index when unreachable
+		int GetNextHop(int fromIdx, int toIdx) const;
+		// Start and destination included, empty when unreachable
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode) const;
+
+	private:
+		// One Floyd-Warshall pass over tile (blockRow, blockCol) through the nodes of block k
+		void RelaxBlock(int blockRow, int blockCol, int k);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+
+		// Row-major, padded to a multiple of BlockSize, pair (i, j) is at i * m_Stride + j
+		int m_NrOfNodes = 0;
+		int m_Stride = 0;
+		std::vector<float> m_Distances;
+		std::vector<int> m_NextHops;
+
+		double m_LastBuildSeconds = 0.0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	AllPairsShortestPaths<T_NodeType, T_ConnectionType>::AllPairsShortestPaths(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void AllPairsShortestPaths<T_NodeType, T_ConnectionType>::Build(unsigned int nrOfThreads)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+
+		if (nrOfThreads == 0)
+			nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// 1. Direct connections, the cheapest one if a pair has several
+		m_NrOfNodes = m_pGraph->GetNrOfNodes();
+		const int nrOfBlocks = (m_NrOfNodes + BlockSize - 1) / BlockSize;
+		m_Stride = nrOfBlocks * BlockSize;
+		m_Distances.assign(size_t(m_Stride) * m_Stride, std::numeric_limits<float>::max());
+		m_NextHops.assign(size_t(m_Stride) * m_Stride, invalid_node_index);
+
+		// Removed nodes stay in the graph with an invalid index
+		auto isActive = [this](int idx) { return m_pGraph->GetNode(idx)->GetIndex() != invalid_node_index; };
+		for (int idx = 0; idx < m_NrOfNodes; ++idx)
+		{
+			if (!isActive(idx))
+				continue;
+
+			const size_t row = size_t(idx) * m_Stride;
+			m_Distances[row + idx] = 0.f;
+			m_NextHops[row + idx] = idx;
+			for (const auto& pConnection : m_pGraph->GetNodeConnections(idx))
+			{
+				const int toIdx = pConnection->GetTo();
+				if (isActive(toIdx) && pConnection->GetCost() < m_Distances[row + toIdx])
+				{
+					m_Distances[row + toIdx] = pConnection->GetCost();
+					m_NextHops[row + toIdx] = toIdx;
+				}
+			}
+		}
+
+		// 2. Blocked Floyd-Warshall, the threads meet on a barrier after every phase
+		nrOfThreads = std::min(nrOfThreads, static_cast<unsigned int>(std::max(1, nrOfBlocks * nrOfBlocks)));
+		SpinBarrier barrier{ int(nrOfThreads) };
+
+		auto worker = [&](unsigned int threadIdx)
+		{
+			for (int k = 0; k < nrOfBlocks; ++k)
+			{
+				// 2.1 The diagonal tile only depends on itself
+				if (threadIdx == 0)
+					RelaxBlock(k, k, k);
+				barrier.Wait();
+
+				// 2.2 Tiles in row k and column k only depend on themselves and the diagonal tile
+				for (int b = int(threadIdx); b < 2 * nrOfBlocks; b += int(nrOfThreads))
+				{
+					const int other = b / 2;
+					if (other == k)
+						continue;
+
+					if (b % 2 == 0)
+						RelaxBlock(k, other, k);
+					else
+						RelaxBlock(other, k, k);
+				}
+				barrier.Wait();
+
+				// 2.3 Every other tile reads one tile of row k and one of column k
+				for (int b = int(threadIdx); b < nrOfBlocks * nrOfBlocks; b += int(nrOfThreads))
+				{
+					const int blockRow = b / nrOfBlocks;
+					const int blockCol = b % nrOfBlocks;
+					if (blockRow != k && blockCol != k)
+						RelaxBlock(blockRow, blockCol, k);
+				}
+				barrier.Wait();
+			}
+		};
+
+		std::vector<std::thread> threads{};
+		for (unsigned int i = 1; i < nrOfThreads; ++i)
+			threads.emplace_back(worker, i);
+		worker(0);
+		for (auto& thread : threads)
+			thread.join();
+
+		m_LastBuildSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void AllPairsShortestPaths<T_NodeType, T_ConnectionType>::RelaxBlock(int blockRow, int blockCol, int k)
+	{
+		const int rowBegin = blockRow * BlockSize;
+		const int colBegin = blockCol * BlockSize;
+		const int kBegin = k * BlockSize;
+
+		for (int viaIdx = kBegin; viaIdx < kBegin + BlockSize; ++viaIdx)
+		{
+			const float* viaDistances = &m_Distances[size_t(viaIdx) * m_Stride + colBegin];
+			for (int fromIdx = rowBegin; fromIdx < rowBegin + BlockSize; ++fromIdx)
+			{
+				const size_t row = size_t(fromIdx) * m_Stride;
+				const float toVia = m_Distances[row + viaIdx];
+				if (toVia == std::numeric_limits<float>::max())
+					continue;
+
+				const int hopToVia = m_NextHops[row + viaIdx];
+				float* distances = &m_Distances[row + colBegin];
+				int* nextHops = &m_NextHops[row + colBegin];
+				for (int j = 0; j < BlockSize; ++j)
+				{
+					// Unreachable is float max, the sum then overflows to infinity and never wins
+					const float distance = toVia + viaDistances[j];
+					if (distance < distances[j])
+					{
+						distances[j] = distance;
+						nextHops[j] = hopToVia;
+					}
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float AllPairsShortestPaths<T_NodeType, T_ConnectionType>::GetDistance(int fromIdx, int toIdx) const
+	{
+		assert(IsBuilt() && fromIdx >= 0 && fromIdx < m_NrOfNodes && toIdx >= 0 && toIdx < m_NrOfNodes
+			&& "<AllPairsShortestPaths::GetDistance>: not built or invalid node index");
+		return m_Distances[size_t(fromIdx) * m_Stride + toIdx];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int AllPairsShortestPaths<T_NodeType, T_ConnectionType>::GetNextHop(int fromIdx, int toIdx) const
+	{
+		assert(IsBuilt() && fromIdx >= 0 && fromIdx < m_NrOfNodes && toIdx >= 0 && toIdx < m_NrOfNodes
+			&& "<AllPairsShortestPaths::GetNextHop>: not built or invalid node index");
+		return m_NextHops[size_t(fromIdx) * m_Stride + toIdx];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> AllPairsShortestPaths<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode) const
+	{
+		std::vector<T_NodeType*> path{};
+		const int goalIdx = pDestinationNode->GetIndex();
+		int idx = pStartNode->GetIndex();
+		if (GetNextHop(idx, goalIdx) == invalid_node_index)
+			return path;
+
+		path.push_back(pStartNode);
+		while (idx != goalIdx)
+		{
+			idx = GetNextHop(idx, goalIdx);
+			path.push_back(m_pGraph->GetNode(idx));
+		}
+		return path;
+	}
+}
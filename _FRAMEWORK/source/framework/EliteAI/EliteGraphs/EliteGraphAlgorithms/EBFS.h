@@ -1,7 +1,12 @@
 #pragma once
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphViews.h"
 
 namespace Elite 
 {
+	// Breadth first search over a graph view (see EGraphViews.h), returns the node indices from start to goal (empty when unreachable)
+	template <class T_GraphView>
+	std::vector<int> FindPathBFS(const T_GraphView& graph, int startIdx, int goalIdx);
+
 	template <class T_NodeType, class T_ConnectionType>
 	class BFS
 	{
@@ -22,47 +27,57 @@ namespace Elite
 	template <class T_NodeType, class T_ConnectionType>
 	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
 	{
-		std::queue<T_NodeType*> openList; // Frontier - Expanding Edge
-		std::map<T_NodeType*, T_NodeType*> closedList; // Already checked nodes
+		// Unreachable destinations are rejected without flooding the whole component
+		if (!m_pGraph->AreConnected(pStartNode->GetIndex(), pDestinationNode->GetIndex()))
+			return {};
+
+		const std::vector<int> pathIndices = FindPathBFS(IGraphView<T_NodeType, T_ConnectionType>{ m_pGraph }, pStartNode->GetIndex(), pDestinationNode->GetIndex());
+
+		std::vector<T_NodeType*> path{};
+		path.reserve(pathIndices.size());
+		for (int idx : pathIndices)
+			path.push_back(m_pGraph->GetNode(idx));
+
+		return path;
+	}
+
+	template <class T_GraphView>
+	std::vector<int> FindPathBFS(const T_GraphView& graph, int startIdx, int goalIdx)
+	{
+		static_assert(IsGraphView_v<T_GraphView>, "<FindPathBFS>: T_GraphView doesn't offer the graph view interface");
 
-		openList.push(pStartNode); // Kickstarting the loop
+		std::vector<int> parents(graph.GetNrOfNodes(), invalid_node_index); // also marks the nodes that were reached
+		std::queue<int> openList; // Frontier - Expanding Edge
 
-		while (!openList.empty())
+		parents[startIdx] = startIdx;
+		openList.push(startIdx);
+
+		while (!openList.empty() && parents[goalIdx] == invalid_node_index)
 		{
-			T_NodeType* pCurrentNode = openList.front();
+			const int idx = openList.front();
 			openList.pop();
 
-			if (pCurrentNode == pDestinationNode)
-			{
-				break;
-			}
-
-			// Loop over all connections of the current node
-			for (auto con : m_pGraph->GetNodeConnections(pCurrentNode))
-			{
-				T_NodeType* pNextNode = m_pGraph->GetNode(con->GetTo());
-				if (closedList.find(pNextNode) == closedList.end()) // next node is not part of closed list
+			graph.ForEachNeighbor(idx, [&](int toIdx, float)
 				{
-					openList.push(pNextNode);
-					closedList[pNextNode] = pCurrentNode;
-				}
-			}
-		}
+					if (parents[toIdx] != invalid_node_index)
+						return;
 
-		// We found the goal node, track back from goal node to start node to create path
-		vector<T_NodeType*> path;
-		T_NodeType* pNode = pDestinationNode; // Start tracking back from end node
-		while (pNode != pStartNode)
-		{
-			path.push_back(pNode);
-			pNode = closedList[pNode];
+					parents[toIdx] = idx;
+					openList.push(toIdx);
+				});
 		}
 
-		path.push_back(pStartNode); // Start node is not part of path, manually add it to the path
+		// Frontier ran out without reaching the goal node (possible in directional graphs)
+		if (parents[goalIdx] == invalid_node_index)
+			return {};
 
-		std::reverse(path.begin(), path.end());
+		// Track back from goal node to start node
+		std::vector<int> path{};
+		for (int idx = goalIdx; idx != startIdx; idx = parents[idx])
+			path.push_back(idx);
+		path.push_back(startIdx);
 
+		std::reverse(path.begin(), path.end());
 		return path;
 	}
 }
-
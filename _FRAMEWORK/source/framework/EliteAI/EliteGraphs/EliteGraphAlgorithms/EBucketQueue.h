@@ -0,0 +1,76 @@
+#pragma once
+#include <assert.h>
+
+namespace Elite
+{
+	// Priority queue for small non-negative integer keys (Dial's algorithm): one bucket per key value
+	// Push is O(1) and Pop is amortized O(1) as long as keys mostly grow, which holds for Dijkstra and for A* with a consistent heuristic.
+	// Keys below the last popped one are still accepted, the search for the minimum then restarts from that key.
+	template <class T_Value>
+	class BucketQueue
+	{
+	public:
+		void Push(size_t key, const T_Value& value);
+		// Removes and returns a value with the smallest key, values with equal keys come out last in first out
+		T_Value Pop();
+		// Smallest key in the queue, the queue can't be empty
+		size_t GetMinKey();
+
+		bool IsEmpty() const { return m_Size == 0; }
+		size_t GetSize() const { return m_Size; }
+
+		// Keeps the buckets' memory, so a queue can be reused over many searches
+		void Clear();
+
+	private:
+		std::vector<std::vector<T_Value>> m_Buckets;
+		size_t m_MinKey = 0; // no bucket below this one holds values
+		size_t m_Size = 0;
+	};
+
+	template <class T_Value>
+	void BucketQueue<T_Value>::Push(size_t key, const T_Value& value)
+	{
+		if (key >= m_Buckets.size())
+			m_Buckets.resize(key + 1);
+
+		m_Buckets[key].push_back(value);
+		m_MinKey = IsEmpty() ? key : std::min(m_MinKey, key);
+		++m_Size;
+	}
+
+	template <class T_Value>
+	T_Value BucketQueue<T_Value>::Pop()
+	{
+		assert(!IsEmpty() && "<BucketQueue::Pop>: queue is empty");
+
+		while (m_Buckets[m_MinKey].empty())
+			++m_MinKey;
+
+		T_Value value = m_Buckets[m_MinKey].back();
+		m_Buckets[m_MinKey].pop_back();
+		--m_Size;
+		return value;
+	}
+
+	template <class T_Value>
+	size_t BucketQueue<T_Value>::GetMinKey()
+	{
+		assert(!IsEmpty() && "<BucketQueue::GetMinKey>: queue is empty");
+
+		while (m_Buckets[m_MinKey].empty())
+			++m_MinKey;
+
+		return m_MinKey;
+	}
+
+	template <class T_Value>
+	void BucketQueue<T_Value>::Clear()
+	{
+		for (auto& bucket : m_Buckets)
+			bucket.clear();
+
+		m_MinKey = 0;
+		m_Size = 0;
+	}
+}
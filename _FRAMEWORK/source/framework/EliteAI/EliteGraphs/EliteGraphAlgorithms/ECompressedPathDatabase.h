@@ -0,0 +1,241 @@
+#pragma once
+#include <assert.h>
+#include "EGridFirstMoves.h"
+
+namespace Elite
+{
+	// Compressed path database (first-move table) for grids that don't change
+	// Build runs a Dijkstra from every walkable cell (see GridFirstMoves) and stores, for every target, the first move of an optimal path there.
+	// Each source's row of moves is run-length compressed over the target indices (GridLayout::Tiled groups nearby targets,
+	// which gives longer runs). Queries don't search, they follow first moves to the goal.
+	// Only connections between adjacent cells are used, the table has to be rebuilt when the grid changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class CompressedPathDatabase
+	{
+	public:
+		CompressedPathDatabase(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Offline step, nrOfThreads = 0 uses all cores
+		void Build(unsigned int nrOfThreads = 0);
+		bool IsBuilt() const { return !m_RowOffsets.empty(); }
+
+		// Next node on an optimal path from fromIdx to toIdx, invalid_node_index if toIdx can't be reached
+		// toIdx has to be walkable, water targets share the entries of their neighbours to keep the table small
+		int GetNextNodeIdx(int fromIdx, int toIdx) const;
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) const;
+
+		int GetNrOfRuns() const { return int(m_Runs.size()); }
+
+		// Same conventions as GridGraph::SaveToFile/LoadFromFile, loading fails if the file was built for another grid size or layout
+		// or has a run with a target outside the grid, out of order, or with a move that leaves the grid
+		bool SaveToFile(const std::string& filePath) const;
+		bool LoadFromFile(const std::string& filePath);
+
+	private:
+		using FirstMoves = GridFirstMoves<T_NodeType, T_ConnectionType>;
+
+		// A move is a direction of GridFirstMoves, NoMove means unreachable
+		static constexpr uint32_t NoMove = FirstMoves::NoDirection;
+		static constexpr int MoveBits = 4;
+
+		// Fills row with the compressed first moves from sourceIdx
+		void BuildRow(int sourceIdx, typename FirstMoves::Scratch& scratch, std::vector<uint32_t>& row) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		FirstMoves m_FirstMoves;
+
+		// Runs of source i are m_Runs[m_RowOffsets[i] .. m_RowOffsets[i + 1]]
+		std::vector<uint32_t> m_RowOffsets;
+		std::vector<uint32_t> m_Runs;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	CompressedPathDatabase<T_NodeType, T_ConnectionType>::CompressedPathDatabase(GridGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+		, m_FirstMoves(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CompressedPathDatabase<T_NodeType, T_ConnectionType>::Build(unsigned int nrOfThreads)
+	{
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		assert(nrOfNodes < (1 << (32 - MoveBits)) && "<CompressedPathDatabase::Build>: grid too large for the run encoding");
+
+		// Every source gets its own row
+		std::vector<std::vector<uint32_t>> rows(nrOfNodes);
+		m_FirstMoves.ForEverySource(nrOfThreads, [&](int sourceIdx, typename FirstMoves::Scratch& scratch) { BuildRow(sourceIdx, scratch, rows[sourceIdx]); });
+
+		m_RowOffsets.assign(1, 0);
+		m_Runs.clear();
+		for (const auto& row : rows)
+		{
+			m_Runs.insert(m_Runs.end(), row.begin(), row.end());
+			m_RowOffsets.push_back(uint32_t(m_Runs.size()));
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int CompressedPathDatabase<T_NodeType, T_ConnectionType>::GetNextNodeIdx(int fromIdx, int toIdx) const
+	{
+		assert(IsBuilt() && "<CompressedPathDatabase::GetNextNodeIdx>: Build or LoadFromFile has to be called first");
+		assert(fromIdx >= 0 && fromIdx + 1 < int(m_RowOffsets.size()) && "<CompressedPathDatabase::GetNextNodeIdx>: fromIdx is not a cell of the grid");
+
+		// The source's own entry is a wildcard in the table
+		if (fromIdx == toIdx)
+			return toIdx;
+
+		// Last run that starts at or before the target
+		auto rowBegin = m_Runs.begin() + m_RowOffsets[fromIdx];
+		auto rowEnd = m_Runs.begin() + m_RowOffsets[fromIdx + 1];
+		auto runIt = std::upper_bound(rowBegin, rowEnd, (uint32_t(toIdx) << MoveBits) | NoMove);
+		if (runIt == rowBegin)
+			return invalid_node_index;
+
+		uint32_t move = *(runIt - 1) & NoMove;
+		if (move == NoMove)
+			return invalid_node_index;
+
+		return m_FirstMoves.GetNeighborIdx(fromIdx, move);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> CompressedPathDatabase<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) const
+	{
+		std::vector<T_NodeType*> path{ pStartNode };
+
+		const int goalIdx = pGoalNode->GetIndex();
+		if (!m_pGraph->IsWalkable(goalIdx))
+			return {};
+
+		// An optimal path never visits a node twice, a longer walk means the table doesn't belong to this grid anymore
+		const int maxNrOfSteps = m_pGraph->GetNrOfNodes();
+		for (int idx = pStartNode->GetIndex(), nrOfSteps = 0; idx != goalIdx; ++nrOfSteps)
+		{
+			if (nrOfSteps == maxNrOfSteps)
+				return {};
+
+			idx = GetNextNodeIdx(idx, goalIdx);
+			if (idx == invalid_node_index)
+				return {};
+
+			path.push_back(m_pGraph->GetNode(idx));
+		}
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool CompressedPathDatabase<T_NodeType, T_ConnectionType>::SaveToFile(const std::string& filePath) const
+	{
+		using namespace GraphFileFormat;
+
+		std::ofstream file{ filePath, std::ios::binary };
+		if (!file)
+			return false;
+
+		PathDatabaseHeader header = m_FirstMoves.template CreateHeader<PathDatabaseHeader>(PathDatabaseMagic, PathDatabaseVersion);
+		header.nrOfRuns = uint32_t(m_Runs.size());
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(m_RowOffsets.data()), m_RowOffsets.size() * sizeof(uint32_t));
+		file.write(reinterpret_cast<const char*>(m_Runs.data()), m_Runs.size() * sizeof(uint32_t));
+
+		return file.good();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool CompressedPathDatabase<T_NodeType, T_ConnectionType>::LoadFromFile(const std::string& filePath)
+	{
+		using namespace GraphFileFormat;
+
+		MemoryMappedFile file{ filePath };
+
+		const PathDatabaseHeader* pHeader = m_FirstMoves.template GetHeader<PathDatabaseHeader>(file, PathDatabaseMagic, PathDatabaseVersion);
+		if (pHeader == nullptr)
+			return false;
+
+		const uint64_t nrOfOffsets = uint64_t(pHeader->columns) * uint64_t(pHeader->rows) + 1;
+		const uint64_t runsOffset = sizeof(PathDatabaseHeader) + nrOfOffsets * sizeof(uint32_t);
+
+		const uint32_t* pRowOffsets = file.GetAt<uint32_t>(sizeof(PathDatabaseHeader), nrOfOffsets);
+		const uint32_t* pRuns = file.GetAt<uint32_t>(runsOffset, pHeader->nrOfRuns);
+		if (pRowOffsets == nullptr || (pRuns == nullptr && pHeader->nrOfRuns > 0) || pRowOffsets[nrOfOffsets - 1] != pHeader->nrOfRuns)
+			return false;
+
+		// Queries index the runs through the row offsets, they have to stay inside them
+		for (uint64_t i = 1; i < nrOfOffsets; ++i)
+		{
+			if (pRowOffsets[i] < pRowOffsets[i - 1])
+				return false;
+		}
+
+		// Queries binary search a row and step to the neighbour its move points at, so the targets of a row have to be
+		// increasing and inside the grid, and every move has to be a direction that stays on the grid
+		const int nrOfCells = int(nrOfOffsets - 1);
+		for (int sourceIdx = 0; sourceIdx < nrOfCells; ++sourceIdx)
+		{
+			int64_t prevTargetIdx = -1;
+			for (uint32_t i = pRowOffsets[sourceIdx]; i < pRowOffsets[sourceIdx + 1]; ++i)
+			{
+				const int64_t targetIdx = pRuns[i] >> MoveBits;
+				const uint32_t move = pRuns[i] & NoMove;
+				if (targetIdx <= prevTargetIdx || targetIdx >= nrOfCells)
+					return false;
+				if (move != NoMove && m_FirstMoves.GetNeighborIdx(sourceIdx, move) == invalid_node_index)
+					return false;
+
+				prevTargetIdx = targetIdx;
+			}
+		}
+
+		m_RowOffsets.assign(pRowOffsets, pRowOffsets + size_t(nrOfOffsets));
+		m_Runs.assign(pRuns, pRuns + pHeader->nrOfRuns);
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CompressedPathDatabase<T_NodeType, T_ConnectionType>::BuildRow(int sourceIdx, typename FirstMoves::Scratch& scratch, std::vector<uint32_t>& row) const
+	{
+		// A move set has bit d set when direction d starts an optimal path to the target, bit NoMove means unreachable
+		const uint16_t unreachable = 1 << NoMove;
+		const uint16_t anyMove = 0xFFFF;
+
+		// Water cells are never a source, every target stays unreachable
+		m_FirstMoves.FindFirstMoves(sourceIdx, 1, scratch);
+
+		// Nobody asks for a path to water and the source's own entry is a wildcard, so those entries can join any run
+		auto getMoveSet = [&](int targetIdx) -> uint16_t
+		{
+			if (targetIdx == sourceIdx || !m_pGraph->IsWalkable(targetIdx))
+				return anyMove;
+			return scratch.directionSets[targetIdx] == 0 ? unreachable : scratch.directionSets[targetIdx];
+		};
+
+		// Run-length compression over the target indices, a run keeps going as long as one move is optimal for all of its targets
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		row.clear();
+		int runStartIdx = 0;
+		uint16_t runMoves = anyMove;
+		auto addRun = [&]()
+		{
+			uint32_t move = 0;
+			while ((runMoves & (1 << move)) == 0)
+				++move;
+			row.push_back((uint32_t(runStartIdx) << MoveBits) | move);
+		};
+
+		for (int targetIdx = 0; targetIdx < nrOfNodes; ++targetIdx)
+		{
+			const uint16_t moveSet = getMoveSet(targetIdx);
+			if ((runMoves & moveSet) == 0)
+			{
+				addRun();
+				runStartIdx = targetIdx;
+				runMoves = anyMove;
+			}
+			runMoves &= moveSet;
+		}
+		addRun();
+	}
+}
@@ -0,0 +1,452 @@
+#pragma once
+#include <assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+namespace Elite
+{
+	// Windowed hierarchical cooperative A* (WHCA*) for many agents on one GridGraph
+	// Agents plan one after the other in priority order through space and time. Every planned step goes into a hashed
+	// space-time reservation table, so lower priority agents plan around the cells (and swaps) of the higher ones.
+	// Plans only look windowSize steps ahead, past the window the cost to go is the true distance to the goal. That comes
+	// from a reverse search from the goal which is resumed on demand (reverse resumable A*), so it only grows as far as it
+	// gets queried. Agents with the same goal share one. All agents replan every replanInterval steps, which rolls the
+	// window along with them.
+	// Memory is bounded: the table holds nrOfAgents * (windowSize + 1) reservations, a space-time search reaches at most
+	// (windowSize + 1) * (2 * windowSize + 1)^2 states and the reverse searches together keep about maxDistanceRecords
+	// cells (0 is sixteen grids' worth). Past that the least recently used ones start over from their goal.
+	// Containers keep their memory between frames.
+	// The grid is assumed undirected (same cost both ways) and the heuristic has to be consistent for the default
+	// costs (e.g. Chebyshev or Octile), otherwise the reverse search doesn't give true distances.
+	template <class T_NodeType, class T_ConnectionType>
+	class CooperativeAStar
+	{
+	public:
+		CooperativeAStar(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int windowSize = 16, int replanInterval = 8, int maxDistanceRecords = 0);
+
+		// Lower priority values plan first, equal priorities plan in the order the agents were added
+		int AddAgent(int startIdx, int goalIdx, int priority = 0);
+		void SetAgentGoal(int agentId, int goalIdx);
+		void SetAgentPriority(int agentId, int priority);
+		void ClearAgents();
+
+		// Replans when the window ran out (or a goal or priority changed) and moves every agent one step along its plan
+		void Step();
+		// Plans every agent from its current cell for the next windowSize steps
+		void Replan();
+
+		int GetNrOfAgents() const { return int(m_Agents.size()); }
+		// Cell the agent is on after stepsAhead more steps, as far as the current plan reaches
+		int GetAgentNodeIdx(int agentId, int stepsAhead = 0) const;
+		int GetAgentGoal(int agentId) const { return m_Agents[agentId].goalIdx; }
+		bool HasReachedGoal(int agentId) const { return GetAgentNodeIdx(agentId) == m_Agents[agentId].goalIdx; }
+
+		static constexpr int NoAgent = -1;
+
+	private:
+		struct OpenRecord
+		{
+			uint64_t key;
+			float fCost;
+			int time; // deeper states win ties, that finishes plans sooner
+
+			bool operator>(const OpenRecord& other) const { return fCost > other.fCost || (fCost == other.fCost && time < other.time); }
+		};
+
+		struct SearchRecord
+		{
+			float gCost;
+			uint64_t parentKey;
+			bool isClosed;
+		};
+
+		struct DistanceRecord
+		{
+			float gCost;
+			bool isClosed;
+		};
+
+		struct Agent
+		{
+			int goalIdx;
+			int priority;
+			std::vector<int> plan; // cell per step since the last Replan
+		};
+
+		// Reverse search from a goal, towards the first cell it was asked for
+		struct DistanceTable
+		{
+			int targetIdx;
+			int nrOfAgents;
+			int lastUsedReplan;
+			std::unordered_map<int, DistanceRecord> records;
+			std::vector<OpenRecord> openList; // key is the cell
+		};
+
+		static uint64_t GetKey(int idx, int time) { return (uint64_t(time) << 32) | uint32_t(idx); }
+		static int GetIdx(uint64_t key) { return int(key & 0xFFFFFFFF); }
+		static int GetTime(uint64_t key) { return int(key >> 32); }
+
+		int GetReservation(int idx, int time) const;
+		void PlanAgent(int agentId);
+		bool IsFreeUntilWindowEnd(int idx, int time) const;
+
+		void AcquireDistanceTable(int goalIdx);
+		void ReleaseDistanceTable(int goalIdx);
+		void ResetDistanceTable(int goalIdx, DistanceTable& table);
+		// Starts the least recently used reverse searches over until the records are down to 3/4 of the budget
+		void EvictDistanceTables(int goalIdx);
+		// Resumes the reverse search from goalIdx until idx is closed
+		float GetTrueDistance(int goalIdx, int idx);
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_WindowSize;
+		int m_ReplanInterval;
+		size_t m_MaxDistanceRecords;
+
+		std::vector<Agent> m_Agents;
+		std::vector<int> m_PlanOrder;
+		int m_NrOfReplans = 0;
+		int m_StepsSinceReplan = 0;
+		bool m_NeedsReplan = true;
+
+		// Space-time reservations of the current window, time relative to the last Replan
+		std::unordered_map<uint64_t, int> m_Reservations;
+
+		// Space-time search state, reused over the agents
+		std::unordered_map<uint64_t, SearchRecord> m_SearchRecords;
+		std::vector<OpenRecord> m_OpenList;
+
+		// Reverse searches per goal cell, shared by the agents heading there
+		std::unordered_map<int, DistanceTable> m_DistanceTables;
+		size_t m_NrOfDistanceRecords = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	CooperativeAStar<T_NodeType, T_ConnectionType>::CooperativeAStar(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int windowSize, int replanInterval, int maxDistanceRecords)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_WindowSize(windowSize)
+		, m_ReplanInterval(replanInterval)
+		, m_MaxDistanceRecords(maxDistanceRecords > 0 ? size_t(maxDistanceRecords) : 16 * size_t(pGraph->GetNrOfNodes()))
+	{
+		assert(windowSize > 0 && replanInterval > 0 && replanInterval <= windowSize && "<CooperativeAStar::CooperativeAStar>: replanInterval has to be in [1, windowSize]");
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int CooperativeAStar<T_NodeType, T_ConnectionType>::AddAgent(int startIdx, int goalIdx, int priority)
+	{
+		assert(m_pGraph->IsWalkable(startIdx) && m_pGraph->IsWalkable(goalIdx) && "<CooperativeAStar::AddAgent>: start and goal have to be walkable");
+
+		Agent agent{};
+		agent.goalIdx = goalIdx;
+		agent.priority = priority;
+		agent.plan.push_back(startIdx);
+		AcquireDistanceTable(goalIdx);
+
+		m_Agents.push_back(std::move(agent));
+		m_NeedsReplan = true;
+		return int(m_Agents.size()) - 1;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::SetAgentGoal(int agentId, int goalIdx)
+	{
+		assert(m_pGraph->IsWalkable(goalIdx) && "<CooperativeAStar::SetAgentGoal>: goal has to be walkable");
+
+		Agent& agent = m_Agents[agentId];
+		if (agent.goalIdx == goalIdx)
+			return;
+
+		// The plan is kept until the next Replan, so the agent's current cell has to be read before
+		const int currentIdx = GetAgentNodeIdx(agentId);
+		ReleaseDistanceTable(agent.goalIdx);
+		agent.goalIdx = goalIdx;
+		agent.plan.assign(1, currentIdx);
+		AcquireDistanceTable(goalIdx);
+		m_NeedsReplan = true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::SetAgentPriority(int agentId, int priority)
+	{
+		m_Agents[agentId].priority = priority;
+		m_NeedsReplan = true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::ClearAgents()
+	{
+		m_Agents.clear();
+		m_PlanOrder.clear();
+		m_Reservations.clear();
+		m_DistanceTables.clear();
+		m_NrOfDistanceRecords = 0;
+		m_NeedsReplan = true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int CooperativeAStar<T_NodeType, T_ConnectionType>::GetAgentNodeIdx(int agentId, int stepsAhead) const
+	{
+		const std::vector<int>& plan = m_Agents[agentId].plan;
+		return plan[std::min(m_StepsSinceReplan + stepsAhead, int(plan.size()) - 1)];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::Step()
+	{
+		if (m_NeedsReplan || m_StepsSinceReplan >= m_ReplanInterval)
+			Replan();
+
+		++m_StepsSinceReplan;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::Replan()
+	{
+		// Every agent starts from where its old plan has it now
+		for (int agentId = 0; agentId < GetNrOfAgents(); ++agentId)
+			m_Agents[agentId].plan.assign(1, GetAgentNodeIdx(agentId));
+		m_StepsSinceReplan = 0;
+		m_NeedsReplan = false;
+		++m_NrOfReplans;
+
+		m_PlanOrder.resize(m_Agents.size());
+		for (int agentId = 0; agentId < GetNrOfAgents(); ++agentId)
+			m_PlanOrder[agentId] = agentId;
+		std::stable_sort(m_PlanOrder.begin(), m_PlanOrder.end(), [this](int a, int b) { return m_Agents[a].priority < m_Agents[b].priority; });
+
+		m_Reservations.clear();
+		m_Reservations.reserve(m_Agents.size() * (m_WindowSize + 1));
+		for (int agentId : m_PlanOrder)
+			PlanAgent(agentId);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int CooperativeAStar<T_NodeType, T_ConnectionType>::GetReservation(int idx, int time) const
+	{
+		auto it = m_Reservations.find(GetKey(idx, time));
+		return it != m_Reservations.end() ? it->second : NoAgent;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool CooperativeAStar<T_NodeType, T_ConnectionType>::IsFreeUntilWindowEnd(int idx, int time) const
+	{
+		for (int t = time + 1; t <= m_WindowSize; ++t)
+		{
+			if (GetReservation(idx, t) != NoAgent)
+				return false;
+		}
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::PlanAgent(int agentId)
+	{
+		Agent& agent = m_Agents[agentId];
+		const int startIdx = agent.plan[0];
+		const int goalIdx = agent.goalIdx;
+
+		m_SearchRecords.clear();
+		m_OpenList.clear();
+		m_DistanceTables.at(goalIdx).lastUsedReplan = m_NrOfReplans;
+
+		// 1. Space-time A*, waiting in place is a move as well (free on the goal)
+		uint64_t endKey = GetKey(startIdx, 0);
+		bool foundPlan = false;
+		if (m_pGraph->AreConnected(startIdx, goalIdx))
+		{
+			m_SearchRecords[endKey] = { 0.f, endKey, false };
+			m_OpenList.push_back({ endKey, GetTrueDistance(goalIdx, startIdx), 0 });
+		}
+
+		auto addState = [&](int fromIdx, int toIdx, int time, float gCost, uint64_t parentKey)
+		{
+			// Cell taken at that time, or a higher priority agent comes the other way
+			if (GetReservation(toIdx, time + 1) != NoAgent)
+				return;
+			const int oncomingAgent = GetReservation(toIdx, time);
+			if (fromIdx != toIdx && oncomingAgent != NoAgent && GetReservation(fromIdx, time + 1) == oncomingAgent)
+				return;
+
+			const uint64_t key = GetKey(toIdx, time + 1);
+			auto it = m_SearchRecords.find(key);
+			if (it != m_SearchRecords.end() && (it->second.isClosed || it->second.gCost <= gCost))
+				return;
+
+			m_SearchRecords[key] = { gCost, parentKey, false };
+			m_OpenList.push_back({ key, gCost + GetTrueDistance(goalIdx, toIdx), time + 1 });
+			std::push_heap(m_OpenList.begin(), m_OpenList.end(), std::greater<OpenRecord>());
+		};
+
+		while (!m_OpenList.empty())
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end(), std::greater<OpenRecord>());
+			const uint64_t key = m_OpenList.back().key;
+			m_OpenList.pop_back();
+
+			SearchRecord& record = m_SearchRecords[key];
+			if (record.isClosed)
+				continue;
+			record.isClosed = true;
+
+			const int idx = GetIdx(key);
+			const int time = GetTime(key);
+
+			// The window is full, or the agent can stay on its goal for the rest of it
+			if (time == m_WindowSize || (idx == goalIdx && IsFreeUntilWindowEnd(idx, time)))
+			{
+				endKey = key;
+				foundPlan = true;
+				break;
+			}
+
+			const float gCost = record.gCost;
+			addState(idx, idx, time, gCost + (idx == goalIdx ? 0.f : m_pGraph->GetDefaultCostStraight()), key);
+			for (const auto& pConnection : m_pGraph->GetConnections(idx))
+				addState(idx, pConnection->GetTo(), time, gCost + pConnection->GetCost(), key);
+		}
+
+		// 2. Walk back to the start, a boxed in agent (or one without a path) stays where it is
+		std::vector<int>& plan = agent.plan;
+		if (foundPlan)
+		{
+			plan.resize(GetTime(endKey) + 1);
+			for (uint64_t key = endKey; GetTime(key) > 0; key = m_SearchRecords[key].parentKey)
+				plan[GetTime(key)] = GetIdx(key);
+		}
+		plan.resize(m_WindowSize + 1, plan.back());
+
+		// 3. Reserve the whole window, cells already taken stay with the higher priority agent
+		for (int t = 0; t <= m_WindowSize; ++t)
+			m_Reservations.emplace(GetKey(plan[t], t), agentId);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::AcquireDistanceTable(int goalIdx)
+	{
+		auto it = m_DistanceTables.find(goalIdx);
+		if (it == m_DistanceTables.end())
+		{
+			it = m_DistanceTables.emplace(goalIdx, DistanceTable{}).first;
+			ResetDistanceTable(goalIdx, it->second);
+		}
+		++it->second.nrOfAgents;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::ReleaseDistanceTable(int goalIdx)
+	{
+		auto it = m_DistanceTables.find(goalIdx);
+		if (--it->second.nrOfAgents > 0)
+			return;
+
+		m_NrOfDistanceRecords -= it->second.records.size();
+		m_DistanceTables.erase(it);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::ResetDistanceTable(int goalIdx, DistanceTable& table)
+	{
+		m_NrOfDistanceRecords -= table.records.size();
+		table.targetIdx = invalid_node_index; // set by the next query
+		table.records.clear();
+		table.openList.clear();
+
+		table.records[goalIdx] = { 0.f, false };
+		table.openList.push_back({ uint64_t(goalIdx), 0.f, 0 });
+		++m_NrOfDistanceRecords;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CooperativeAStar<T_NodeType, T_ConnectionType>::EvictDistanceTables(int goalIdx)
+	{
+		std::vector<std::pair<int, int>> lastUsed{}; // (replan, goal)
+		for (const auto& table : m_DistanceTables)
+		{
+			if (table.first != goalIdx)
+				lastUsed.push_back({ table.second.lastUsedReplan, table.first });
+		}
+		std::sort(lastUsed.begin(), lastUsed.end());
+
+		// Evicting a quarter at once keeps this from running on every query
+		const size_t targetNrOfRecords = m_MaxDistanceRecords - m_MaxDistanceRecords / 4;
+		for (const auto& table : lastUsed)
+		{
+			if (m_NrOfDistanceRecords <= targetNrOfRecords)
+				return;
+			ResetDistanceTable(table.second, m_DistanceTables.at(table.second));
+		}
+
+		// Still too big on its own
+		if (m_NrOfDistanceRecords > targetNrOfRecords)
+			ResetDistanceTable(goalIdx, m_DistanceTables.at(goalIdx));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float CooperativeAStar<T_NodeType, T_ConnectionType>::GetTrueDistance(int goalIdx, int idx)
+	{
+		DistanceTable& table = m_DistanceTables.at(goalIdx);
+		auto it = table.records.find(idx);
+		if (it != table.records.end() && it->second.isClosed)
+			return it->second.gCost;
+
+		// Only checked before resuming, so one query can always finish (it adds at most one grid's worth)
+		if (m_NrOfDistanceRecords > m_MaxDistanceRecords)
+			EvictDistanceTables(goalIdx);
+
+		// A new search heads for the first cell asked for, that's where an agent is planning from
+		if (table.targetIdx == invalid_node_index)
+		{
+			table.targetIdx = idx;
+			table.openList.front().fCost = GetHeuristicCost(goalIdx, idx);
+		}
+
+		std::vector<OpenRecord>& openList = table.openList;
+		while (!openList.empty())
+		{
+			std::pop_heap(openList.begin(), openList.end(), std::greater<OpenRecord>());
+			const int currentIdx = int(openList.back().key);
+			openList.pop_back();
+
+			DistanceRecord& record = table.records[currentIdx];
+			if (record.isClosed)
+				continue;
+			record.isClosed = true;
+
+			const float gCost = record.gCost;
+			for (const auto& pConnection : m_pGraph->GetConnections(currentIdx))
+			{
+				const int toIdx = pConnection->GetTo();
+				const float newGCost = gCost + pConnection->GetCost();
+
+				auto toIt = table.records.find(toIdx);
+				if (toIt == table.records.end())
+					++m_NrOfDistanceRecords;
+				else if (toIt->second.isClosed || toIt->second.gCost <= newGCost)
+					continue;
+
+				table.records[toIdx] = { newGCost, false };
+				openList.push_back({ uint64_t(toIdx), newGCost + GetHeuristicCost(toIdx, table.targetIdx), 0 });
+				std::push_heap(openList.begin(), openList.end(), std::greater<OpenRecord>());
+			}
+
+			if (currentIdx == idx)
+				return gCost;
+		}
+
+		return std::numeric_limits<float>::max();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float CooperativeAStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
@@ -0,0 +1,312 @@
+#pragma once
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include "framework\EliteHelpers\ESpinBarrier.h"
+
+namespace Elite
+{
+	// Parallel delta-stepping single-source shortest paths (Meyer & Sanders) for full cost fields, e.g. distance or flow fields
+	// Nodes are kept in buckets of width delta on their tentative distance. The lowest bucket is emptied by relaxing its light
+	// edges (cost <= delta) in parallel until nothing falls back into it, then its heavy edges are relaxed once. Distance and
+	// parent of a node share one atomic 64-bit word, so concurrent relaxations keep the lowest distance and a matching parent.
+	// With more than one source every node ends up with the distance to (and parents towards) its nearest source.
+	// Build snapshots the connections, it has to be redone after the graph changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class DeltaStepping
+	{
+	public:
+		DeltaStepping(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Nodes an agent of agentSize doesn't fit on are left out of the snapshot
+		void Build(int agentSize = 1);
+		bool IsBuilt() const { return !m_Offsets.empty(); }
+
+		struct Stats
+		{
+			int nrOfBuckets = 0; // non-empty buckets processed
+			long long nrOfRelaxations = 0; // successful ones, so the work done over Dijkstra's
+			double seconds = 0.0;
+		};
+
+		// Fills distances with the cost from the nearest source (float max when unreachable or beyond maxDistance),
+		// pParents (optional) with the node each node is reached from (invalid_node_index for sources and unreached nodes)
+		// delta = 0 uses the average connection cost, nrOfThreads = 0 uses all cores
+		void Run(const std::vector<int>& sources, std::vector<float>& distances, std::vector<int>* pParents = nullptr,
+			float maxDistance = std::numeric_limits<float>::max(), float delta = 0.f, unsigned int nrOfThreads = 0);
+		const Stats& GetLastStats() const { return m_LastStats; }
+
+	private:
+		// Non-negative floats order the same as their bits, so (distance, parent) compares as one integer
+		static uint64_t Pack(float distance, int parentIdx);
+		static float GetDistance(uint64_t state);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+
+		// Connections of node i are m_Targets/m_Costs[m_Offsets[i] .. m_Offsets[i + 1]]
+		std::vector<int> m_Offsets;
+		std::vector<int> m_Targets;
+		std::vector<float> m_Costs;
+		float m_AverageCost = 1.f;
+
+		Stats m_LastStats{};
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	DeltaStepping<T_NodeType, T_ConnectionType>::DeltaStepping(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DeltaStepping<T_NodeType, T_ConnectionType>::Build(int agentSize)
+	{
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+
+		m_Offsets.assign(1, 0);
+		m_Targets.clear();
+		m_Costs.clear();
+		double totalCost = 0.0;
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			if (m_pGraph->IsNodeValid(idx) && m_pGraph->CanFitAgent(idx, agentSize))
+			{
+				for (const auto& pConnection : m_pGraph->GetNodeConnections(idx))
+				{
+					if (!m_pGraph->CanFitAgent(pConnection->GetTo(), agentSize))
+						continue;
+
+					assert(pConnection->GetCost() >= 0.f && "<DeltaStepping::Build>: connection costs can't be negative");
+					m_Targets.push_back(pConnection->GetTo());
+					m_Costs.push_back(pConnection->GetCost());
+					totalCost += pConnection->GetCost();
+				}
+			}
+			m_Offsets.push_back(int(m_Targets.size()));
+		}
+
+		m_AverageCost = m_Costs.empty() ? 1.f : float(totalCost / m_Costs.size());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DeltaStepping<T_NodeType, T_ConnectionType>::Run(const std::vector<int>& sources, std::vector<float>& distances, std::vector<int>* pParents,
+		float maxDistance, float delta, unsigned int nrOfThreads)
+	{
+		assert(IsBuilt() && "<DeltaStepping::Run>: Build has to be called first");
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+
+		if (nrOfThreads == 0)
+			nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+		if (delta <= 0.f)
+			delta = m_AverageCost > 0.f ? m_AverageCost : 1.f;
+
+		const int nrOfNodes = int(m_Offsets.size()) - 1;
+		const uint64_t unreached = Pack(std::numeric_limits<float>::max(), invalid_node_index);
+		m_LastStats = {};
+
+		std::unique_ptr<std::atomic<uint64_t>[]> states{ new std::atomic<uint64_t>[nrOfNodes] };
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+			states[idx].store(unreached, std::memory_order_relaxed);
+
+		auto getBucket = [delta](float distance) { return size_t(distance / delta); };
+
+		// 1. Shared state, workers only write their own buckets, settled list and counter, worker 0 the rest (between the barriers)
+		std::vector<std::vector<std::vector<int>>> buckets(nrOfThreads);
+		std::vector<std::vector<int>> settled(nrOfThreads);
+		std::vector<long long> relaxations(nrOfThreads, 0);
+		std::vector<int> nodes{};
+		std::vector<int> lastGathered(nrOfNodes, -1);
+		int nrOfGathers = 0;
+		size_t currentBucket = 0;
+		bool isHeavyPhase = false;
+		bool isDone = false;
+
+		for (int sourceIdx : sources)
+		{
+			if (sourceIdx < 0 || sourceIdx >= nrOfNodes || states[sourceIdx].load(std::memory_order_relaxed) != unreached)
+				continue;
+
+			states[sourceIdx].store(Pack(0.f, invalid_node_index), std::memory_order_relaxed);
+			nodes.push_back(sourceIdx);
+		}
+		m_LastStats.nrOfBuckets = nodes.empty() ? 0 : 1;
+		isDone = nodes.empty();
+
+		// Moves the current bucket of every worker into nodes, skipping nodes that moved to a lower bucket since and duplicates
+		auto gatherBucket = [&]()
+		{
+			nodes.clear();
+			++nrOfGathers;
+			for (auto& threadBuckets : buckets)
+			{
+				if (currentBucket >= threadBuckets.size())
+					continue;
+
+				for (int idx : threadBuckets[currentBucket])
+				{
+					if (lastGathered[idx] == nrOfGathers || getBucket(GetDistance(states[idx].load(std::memory_order_relaxed))) != currentBucket)
+						continue;
+
+					lastGathered[idx] = nrOfGathers;
+					nodes.push_back(idx);
+				}
+				threadBuckets[currentBucket].clear();
+			}
+		};
+
+		SpinBarrier barrier{ int(nrOfThreads) };
+
+		auto worker = [&](unsigned int threadIdx)
+		{
+			auto relax = [&](int fromIdx, float fromDistance, int e)
+			{
+				const int toIdx = m_Targets[e];
+				const float toDistance = fromDistance + m_Costs[e];
+				if (toDistance > maxDistance)
+					return;
+
+				const uint64_t newState = Pack(toDistance, fromIdx);
+				uint64_t state = states[toIdx].load(std::memory_order_relaxed);
+				while (newState < state)
+				{
+					if (!states[toIdx].compare_exchange_weak(state, newState, std::memory_order_relaxed))
+						continue;
+
+					auto& threadBuckets = buckets[threadIdx];
+					const size_t bucket = getBucket(toDistance);
+					if (bucket >= threadBuckets.size())
+						threadBuckets.resize(bucket + 1);
+					threadBuckets[bucket].push_back(toIdx);
+					++relaxations[threadIdx];
+					return;
+				}
+			};
+
+			while (true)
+			{
+				barrier.Wait();
+				if (isDone)
+					return;
+
+				// 2. Relax the light (or, once the bucket stays empty, the heavy) edges of this worker's slice
+				const size_t begin = nodes.size() * threadIdx / nrOfThreads;
+				const size_t end = nodes.size() * (threadIdx + 1) / nrOfThreads;
+				for (size_t i = begin; i < end; ++i)
+				{
+					const int idx = nodes[i];
+					const float distance = GetDistance(states[idx].load(std::memory_order_relaxed));
+					for (int e = m_Offsets[idx]; e < m_Offsets[idx + 1]; ++e)
+					{
+						if ((m_Costs[e] > delta) == isHeavyPhase)
+							relax(idx, distance, e);
+					}
+
+					if (!isHeavyPhase)
+						settled[threadIdx].push_back(idx);
+				}
+
+				barrier.Wait();
+				if (threadIdx != 0)
+					continue;
+
+				// 3. Worker 0 picks the next set of nodes
+				if (!isHeavyPhase)
+				{
+					gatherBucket();
+					if (!nodes.empty())
+						continue;
+
+					// The bucket is final, relax the heavy edges of everything that was in it once
+					isHeavyPhase = true;
+					++nrOfGathers;
+					for (auto& threadSettled : settled)
+					{
+						for (int idx : threadSettled)
+						{
+							if (lastGathered[idx] == nrOfGathers)
+								continue;
+							lastGathered[idx] = nrOfGathers;
+							nodes.push_back(idx);
+						}
+						threadSettled.clear();
+					}
+					continue;
+				}
+
+				// Heavy edges are done, move on to the next bucket that has entries left
+				isHeavyPhase = false;
+				nodes.clear();
+				while (nodes.empty())
+				{
+					size_t nextBucket = std::numeric_limits<size_t>::max();
+					for (const auto& threadBuckets : buckets)
+					{
+						for (size_t b = currentBucket + 1; b < threadBuckets.size() && b < nextBucket; ++b)
+						{
+							if (!threadBuckets[b].empty())
+							{
+								nextBucket = b;
+								break;
+							}
+						}
+					}
+
+					if (nextBucket == std::numeric_limits<size_t>::max())
+						break;
+
+					currentBucket = nextBucket;
+					gatherBucket();
+				}
+
+				isDone = nodes.empty();
+				if (!isDone)
+					++m_LastStats.nrOfBuckets;
+			}
+		};
+
+		std::vector<std::thread> threads{};
+		for (unsigned int i = 1; i < nrOfThreads; ++i)
+			threads.emplace_back(worker, i);
+		worker(0);
+		for (auto& thread : threads)
+			thread.join();
+
+		// 4. Unpack
+		distances.resize(nrOfNodes);
+		if (pParents)
+			pParents->resize(nrOfNodes);
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			const uint64_t state = states[idx].load(std::memory_order_relaxed);
+			distances[idx] = GetDistance(state);
+			if (pParents)
+				(*pParents)[idx] = int(uint32_t(state));
+		}
+
+		for (long long count : relaxations)
+			m_LastStats.nrOfRelaxations += count;
+		m_LastStats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	uint64_t DeltaStepping<T_NodeType, T_ConnectionType>::Pack(float distance, int parentIdx)
+	{
+		uint32_t distanceBits;
+		std::memcpy(&distanceBits, &distance, sizeof(distanceBits));
+		return (uint64_t(distanceBits) << 32) | uint32_t(parentIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float DeltaStepping<T_NodeType, T_ConnectionType>::GetDistance(uint64_t state)
+	{
+		const uint32_t distanceBits = uint32_t(state >> 32);
+		float distance;
+		std::memcpy(&distance, &distanceBits, sizeof(distance));
+		return distance;
+	}
+}
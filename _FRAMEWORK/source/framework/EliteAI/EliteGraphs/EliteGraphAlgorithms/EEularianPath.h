@@ -1,5 +1,6 @@
 #pragma once
-#include <stack>
+#include <algorithm>
+#include "EGraphAnalysis.h"
 
 namespace Elite
 {
@@ -40,8 +41,8 @@ namespace Elite
 		vector<T_NodeType*> FindPath(Eulerianity& eulerianity) const;
 
 	private:
-		void VisitAllNodesDFS(int startIdx, vector<bool>& visited) const;
-		bool IsConnected() const;
+		// Odd degree in an undirected graph, in- and out-degree differing in a directional one
+		bool IsUnbalanced(const GraphAnalysis<T_NodeType, T_ConnectionType>& analysis, int idx) const;
 
 		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
 	};
@@ -55,22 +56,26 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline Eulerianity EulerianPath<T_NodeType, T_ConnectionType>::IsEulerian() const
 	{
-		// If the graph is not connected, there can be no Eulerian Trail
-		if (IsConnected() == false)
+		const GraphAnalysis<T_NodeType, T_ConnectionType> analysis{ m_pGraph };
+
+		// If the graph is not connected (or has no connections at all), there can be no Eulerian Trail
+		if (analysis.GetNrOfEdges() == 0 || !analysis.IsConnected())
 		{
 			return Eulerianity::notEulerian;
 		}
 
-		// Count nodes with odd degree 
-		auto activeNodes = m_pGraph->GetAllActiveNodes();
+		// Count nodes with odd degree (for a directional graph: with more or fewer connections in than out)
 		int oddCount = 0;
-		for (auto node : activeNodes)
+		for (int idx = 0; idx < analysis.GetNrOfNodes(); ++idx)
 		{
-			auto connections = m_pGraph->GetNodeConnections(node);
-			if (connections.size() & 1) // check if uneven
-			{
+			if (!analysis.IsActive(idx))
+				continue;
+
+			if (abs(analysis.GetDegree(idx) - analysis.GetInDegree(idx)) > 1)
+				return Eulerianity::notEulerian;
+
+			if (IsUnbalanced(analysis, idx))
 				++oddCount;
-			}
 		}
 
 		// A connected graph with more than 2 nodes with an odd degree (an odd amount of connections) is not Eulerian
@@ -96,126 +101,75 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline vector<T_NodeType*> EulerianPath<T_NodeType, T_ConnectionType>::FindPath(Eulerianity& eulerianity) const
 	{
-		//Start with an empty stack and an empty path
-		
-		auto graphCopy = m_pGraph->Clone();
+		// Hierholzer's algorithm on a flat copy of the connections, used edges are marked instead of removed
 		auto path = vector<T_NodeType*>();
+		if (eulerianity == Eulerianity::notEulerian) // no eulerian circuit exists
+			return path;
 
-		stack<int> myStack{};
-		int nrOfNodes = graphCopy->GetNrOfNodes();
-
-		T_NodeType* pCurrentNode{ nullptr };
-
-		auto& activeNodes{ graphCopy->GetAllActiveNodes() };
+		// 1. Connections in CSR form, in the order of the graph's connection lists
+		const GraphAnalysis<T_NodeType, T_ConnectionType> analysis{ m_pGraph };
 
-		switch (eulerianity)
-		{
-		case Elite::Eulerianity::notEulerian: // no eulerian circuit exists
-			return path;
-		case Elite::Eulerianity::semiEulerian: // if there are exactly 2 vertices having an odd degree, choose one of them
+		// 2. Start node: if there are exactly 2 unbalanced vertices choose one of them (the one with the extra outgoing
+		// connection in a directional graph), otherwise any vertex
+		int startIdx = invalid_node_index;
+		for (int idx = 0; idx < analysis.GetNrOfNodes(); ++idx)
 		{
-			for (T_NodeType* node : activeNodes)
+			if (!analysis.IsActive(idx))
+				continue;
+
+			if (eulerianity == Eulerianity::eulerian || (IsUnbalanced(analysis, idx) && analysis.GetDegree(idx) >= analysis.GetInDegree(idx)))
 			{
-				auto connections = m_pGraph->GetNodeConnections(node);
-				if (connections.size() & 1) // check if uneven
-				{
-					pCurrentNode = node;
-					break;
-				}
+				startIdx = idx;
+				break;
 			}
 		}
-			break;
-		case Elite::Eulerianity::eulerian: // all vertices have even degree, choose any of them
-			pCurrentNode = activeNodes[0];
-			break;
-		default:
-			return path;
-		}
 
-		if (pCurrentNode == nullptr)
-		{
+		if (startIdx == invalid_node_index)
 			return path;
-		}
 
-		do
+		// 3. Walk unused edges, taking the first one left on every node (the cursor skips the used ones), and backtrack
+		// over the stack when stuck. Nodes are added to the path when they are backtracked from, so it comes out reversed.
+		vector<bool> isEdgeUsed(analysis.GetNrOfEdges(), false);
+		vector<int> cursors(analysis.GetNrOfNodes());
+		for (int idx = 0; idx < analysis.GetNrOfNodes(); ++idx)
+			cursors[idx] = analysis.GetFirstConnection(idx);
+		vector<int> nodeStack{};
+
+		int currentIdx = startIdx;
+		while (true)
 		{
-			if (graphCopy->GetNodeConnections(pCurrentNode).size() == 0) // current node has no neighbors
+			int& cursor = cursors[currentIdx];
+			while (cursor < analysis.GetEndConnection(currentIdx) && isEdgeUsed[analysis.GetEdgeId(cursor)])
+				++cursor;
+
+			if (cursor < analysis.GetEndConnection(currentIdx)) // current node does have an unused connection
 			{
-				path.push_back(m_pGraph->GetNode(pCurrentNode->GetIndex()));
-				pCurrentNode = m_pGraph->GetNode(myStack.top());
-				myStack.pop();
+				isEdgeUsed[analysis.GetEdgeId(cursor)] = true;
+				nodeStack.push_back(currentIdx);
+				currentIdx = analysis.GetConnectionTo(cursor);
 			}
-			else // current node does have neigbor
+			else // current node has no unused connections left
 			{
-				myStack.push(pCurrentNode->GetIndex());
-				int indexNext = graphCopy->GetNodeConnections(pCurrentNode->GetIndex()).front()->GetTo(); // get index of any next neighboring node
-				T_NodeType* pNextNode = graphCopy->GetNode(indexNext);
-				graphCopy->RemoveConnection(pCurrentNode->GetIndex(), pNextNode->GetIndex());
-				pCurrentNode = pNextNode;
-			}
-		} while (graphCopy->GetNodeConnections(pCurrentNode).size() != 0 || !myStack.empty());
-		// continue while there ARE connections OR the stack IS NOT empty
-
-		path.push_back(m_pGraph->GetNode(pCurrentNode->GetIndex()));
-		std::reverse(path.begin(), path.end()); // path obtained is in reverse order
-		
-		return path;
-	}
-
-	template<class T_NodeType, class T_ConnectionType>
-	inline void EulerianPath<T_NodeType, T_ConnectionType>::VisitAllNodesDFS(int startIdx, vector<bool>& visited) const
-	{
-		// mark the visited node
-		visited[startIdx] = true;
+				path.push_back(m_pGraph->GetNode(currentIdx));
+				if (nodeStack.empty())
+					break;
 
-		// recursively visit any valid connected nodes that were not visited before
-		for (T_ConnectionType* pConnection : m_pGraph->GetNodeConnections(startIdx))
-		{
-			if (visited[pConnection->GetTo()] == false)
-			{
-				VisitAllNodesDFS(pConnection->GetTo(), visited);
+				currentIdx = nodeStack.back();
+				nodeStack.pop_back();
 			}
 		}
 
+		std::reverse(path.begin(), path.end()); // path obtained is in reverse order
+		return path;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
-	inline bool EulerianPath<T_NodeType, T_ConnectionType>::IsConnected() const
+	inline bool EulerianPath<T_NodeType, T_ConnectionType>::IsUnbalanced(const GraphAnalysis<T_NodeType, T_ConnectionType>& analysis, int idx) const
 	{
-		auto activeNodes = m_pGraph->GetAllActiveNodes();
-		vector<bool> visited(m_pGraph->GetNrOfNodes(), false); // niet active nodes want we gaan dit ook gebruiken voor de index van de nodes
-
-		// find a valid starting node that has connections
-		int connectedIdx = invalid_node_index; // == -1
-		for (auto node : activeNodes)
-		{
-			auto connections = m_pGraph->GetNodeConnections(node);
-			if (connections.size() != 0)
-			{
-				connectedIdx = node->GetIndex(); // autocomplete werkt niet zo goed door template
-				break;
-			}
-		}
-		
-		// if no valid node could be found, return false
-		if (connectedIdx == invalid_node_index)
-		{
-			return false;
-		}
-
-		// start a depth-first-search traversal from the node that has at least one connection
-		VisitAllNodesDFS(connectedIdx, visited);
-
-		// if a node was never visited, this graph is not connected
-		for (auto node : activeNodes)
-		{
-			if (visited[node->GetIndex()] == false)
-			{
-				return false;
-			}
-		}
+		if (m_pGraph->IsDirectionalGraph())
+			return analysis.GetDegree(idx) != analysis.GetInDegree(idx);
 
-		return true;
+		return analysis.GetDegree(idx) & 1; // check if uneven
 	}
 
-}
\ No newline at end of file
+}
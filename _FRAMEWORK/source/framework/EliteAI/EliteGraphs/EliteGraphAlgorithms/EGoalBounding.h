@@ -0,0 +1,155 @@
+#pragma once
+#include <assert.h>
+#include "EGridFirstMoves.h"
+
+namespace Elite
+{
+	// Goal bounding for grids that don't change
+	// Build runs a Dijkstra from every cell (see GridFirstMoves) and, for each of its 8 outgoing directions, stores the bounding box of all
+	// goals that have an optimal path starting in that direction (ties count for every direction). A search towards a goal
+	// outside a direction's box can skip that edge, no optimal path uses it. AStar and the JPS searches take the bounds
+	// through SetGoalBounding, they only prune for the agent size the bounds were built for.
+	// Memory is 8 boxes of 4 uint16 per cell. Build has to be redone when the terrain or the connections change.
+	template <class T_NodeType, class T_ConnectionType>
+	class GoalBounding
+	{
+	public:
+		GoalBounding(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Offline step, nrOfThreads = 0 uses all cores
+		// Cells an agent of agentSize doesn't fit on (see GridGraph::GetClearance) are treated as obstacles
+		void Build(int agentSize = 1, unsigned int nrOfThreads = 0);
+		bool IsBuilt() const { return !m_Boxes.empty(); }
+		int GetAgentSize() const { return m_AgentSize; }
+
+		// False when no optimal path from fromIdx to goalIdx starts with the edge to toIdx
+		// Edges between cells that aren't adjacent are never pruned
+		bool IsEdgeUseful(int fromIdx, int toIdx, int goalIdx) const;
+
+		// Same conventions as GridGraph::SaveToFile/LoadFromFile, loading fails if the file was built for another grid size or layout
+		bool SaveToFile(const std::string& filePath) const;
+		bool LoadFromFile(const std::string& filePath);
+
+	private:
+		using GoalBox = GraphFileFormat::GoalBox;
+		using FirstMoves = GridFirstMoves<T_NodeType, T_ConnectionType>;
+
+		// Boxes are stored in the order of GridFirstMoves' directions
+		static constexpr int NrOfDirections = FirstMoves::NrOfDirections;
+
+		// Fills the boxes of sourceIdx
+		void BuildBoxes(int sourceIdx, typename FirstMoves::Scratch& scratch);
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		FirstMoves m_FirstMoves;
+		int m_AgentSize = 1;
+
+		// Boxes of cell i are m_Boxes[i * NrOfDirections .. (i + 1) * NrOfDirections]
+		std::vector<GoalBox> m_Boxes;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	GoalBounding<T_NodeType, T_ConnectionType>::GoalBounding(GridGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+		, m_FirstMoves(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GoalBounding<T_NodeType, T_ConnectionType>::Build(int agentSize, unsigned int nrOfThreads)
+	{
+		assert(m_pGraph->GetColumns() <= std::numeric_limits<uint16_t>::max() && m_pGraph->GetRows() <= std::numeric_limits<uint16_t>::max()
+			&& "<GoalBounding::Build>: grid too large for the box encoding");
+
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		m_AgentSize = agentSize;
+		m_Boxes.assign(size_t(nrOfNodes) * NrOfDirections, { std::numeric_limits<uint16_t>::max(), std::numeric_limits<uint16_t>::max(), 0, 0 });
+
+		// Every source only writes its own boxes
+		m_FirstMoves.ForEverySource(nrOfThreads, [&](int sourceIdx, typename FirstMoves::Scratch& scratch) { BuildBoxes(sourceIdx, scratch); });
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool GoalBounding<T_NodeType, T_ConnectionType>::IsEdgeUseful(int fromIdx, int toIdx, int goalIdx) const
+	{
+		assert(IsBuilt() && "<GoalBounding::IsEdgeUseful>: Build or LoadFromFile has to be called first");
+
+		const uint32_t direction = m_FirstMoves.GetDirection(fromIdx, toIdx);
+		if (direction == FirstMoves::NoDirection)
+			return true;
+
+		int goalCol, goalRow;
+		m_pGraph->GetColRow(goalIdx, goalCol, goalRow);
+
+		const GoalBox& box = m_Boxes[size_t(fromIdx) * NrOfDirections + direction];
+		return goalCol >= box.minCol && goalCol <= box.maxCol && goalRow >= box.minRow && goalRow <= box.maxRow;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool GoalBounding<T_NodeType, T_ConnectionType>::SaveToFile(const std::string& filePath) const
+	{
+		using namespace GraphFileFormat;
+
+		std::ofstream file{ filePath, std::ios::binary };
+		if (!file)
+			return false;
+
+		GoalBoundingHeader header = m_FirstMoves.template CreateHeader<GoalBoundingHeader>(GoalBoundingMagic, GoalBoundingVersion);
+		header.agentSize = m_AgentSize;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(m_Boxes.data()), m_Boxes.size() * sizeof(GoalBox));
+
+		return file.good();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool GoalBounding<T_NodeType, T_ConnectionType>::LoadFromFile(const std::string& filePath)
+	{
+		using namespace GraphFileFormat;
+
+		MemoryMappedFile file{ filePath };
+
+		const GoalBoundingHeader* pHeader = m_FirstMoves.template GetHeader<GoalBoundingHeader>(file, GoalBoundingMagic, GoalBoundingVersion);
+		if (pHeader == nullptr)
+			return false;
+
+		const uint64_t nrOfBoxes = uint64_t(pHeader->columns) * uint64_t(pHeader->rows) * NrOfDirections;
+		const GoalBox* pBoxes = file.GetAt<GoalBox>(sizeof(GoalBoundingHeader), nrOfBoxes);
+		if (pBoxes == nullptr)
+			return false;
+
+		m_AgentSize = pHeader->agentSize;
+		m_Boxes.assign(pBoxes, pBoxes + size_t(nrOfBoxes));
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GoalBounding<T_NodeType, T_ConnectionType>::BuildBoxes(int sourceIdx, typename FirstMoves::Scratch& scratch)
+	{
+		m_FirstMoves.FindFirstMoves(sourceIdx, m_AgentSize, scratch);
+
+		// Every cell the source reaches grows the box of each direction that starts an optimal path to it
+		GoalBox* pBoxes = &m_Boxes[size_t(sourceIdx) * NrOfDirections];
+		for (int idx = 0; idx < int(scratch.directionSets.size()); ++idx)
+		{
+			const uint8_t directions = scratch.directionSets[idx];
+			if (directions == 0)
+				continue;
+
+			int col, row;
+			m_pGraph->GetColRow(idx, col, row);
+			for (int d = 0; d < NrOfDirections; ++d)
+			{
+				if ((directions & (1 << d)) == 0)
+					continue;
+
+				GoalBox& box = pBoxes[d];
+				box.minCol = std::min(box.minCol, uint16_t(col));
+				box.minRow = std::min(box.minRow, uint16_t(row));
+				box.maxCol = std::max(box.maxCol, uint16_t(col));
+				box.maxRow = std::max(box.maxRow, uint16_t(row));
+			}
+		}
+	}
+}
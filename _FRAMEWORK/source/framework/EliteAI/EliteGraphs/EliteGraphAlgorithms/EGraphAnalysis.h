@@ -0,0 +1,346 @@
+#pragma once
+#include <assert.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace Elite
+{
+	// Disjoint sets over 0 .. n - 1, union by size with path halving
+	class UnionFind
+	{
+	public:
+		explicit UnionFind(int nrOfElements) : m_Parents(nrOfElements), m_Sizes(nrOfElements, 1)
+		{
+			for (int i = 0; i < nrOfElements; ++i)
+				m_Parents[i] = i;
+		}
+
+		int Find(int idx)
+		{
+			while (m_Parents[idx] != idx)
+			{
+				m_Parents[idx] = m_Parents[m_Parents[idx]];
+				idx = m_Parents[idx];
+			}
+			return idx;
+		}
+
+		// False when both were already in the same set
+		bool Union(int a, int b)
+		{
+			a = Find(a);
+			b = Find(b);
+			if (a == b)
+				return false;
+
+			if (m_Sizes[a] < m_Sizes[b])
+				std::swap(a, b);
+			m_Parents[b] = a;
+			m_Sizes[a] += m_Sizes[b];
+			return true;
+		}
+
+		int GetSetSize(int idx) { return m_Sizes[Find(idx)]; }
+
+	private:
+		std::vector<int> m_Parents;
+		std::vector<int> m_Sizes;
+	};
+
+	// Structural queries on a snapshot of a graph: degrees, connectivity, iterative DFS, articulation points and bridges
+	// The constructor copies the connection lists into flat arrays in one pass, every query is linear in nodes + connections
+	// and nothing recurses, so large grids don't run out of stack. In an undirected graph both halves of a connection
+	// share one edge id. Removed nodes are skipped. Has to be rebuilt after the graph changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class GraphAnalysis
+	{
+	public:
+		GraphAnalysis(const IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		int GetNrOfNodes() const { return int(m_IsActive.size()); }
+		bool IsActive(int idx) const { return m_IsActive[idx]; }
+		// Connections (not half connections) in an undirected graph
+		int GetNrOfEdges() const { return m_NrOfEdges; }
+
+		int GetDegree(int idx) const { return m_Offsets[idx + 1] - m_Offsets[idx]; } // outgoing connections
+		int GetInDegree(int idx) const { return m_InDegrees[idx]; } // equals GetDegree in an undirected graph
+
+		// Connections of node i are c = GetFirstConnection(i) .. GetEndConnection(i), in the order of the graph's lists
+		int GetFirstConnection(int idx) const { return m_Offsets[idx]; }
+		int GetEndConnection(int idx) const { return m_Offsets[idx + 1]; }
+		int GetConnectionTo(int c) const { return m_Targets[c]; }
+		int GetEdgeId(int c) const { return m_EdgeIds[c]; }
+
+		// Preorder, following outgoing connections, visit(int idx) is called once per node reached from startIdx
+		template <class T_Visit>
+		void VisitDFS(int startIdx, T_Visit&& visit) const;
+
+		// Connections count in both directions, so a directional graph is weakly connected
+		int GetNrOfComponents() const;
+		bool IsConnected() const { return GetNrOfComponents() <= 1; }
+
+		// Undirected graphs only: nodes and connections whose removal splits their component (chokepoints)
+		std::vector<int> FindArticulationPoints() const;
+		std::vector<std::pair<int, int>> FindBridges() const;
+
+	private:
+		// Iterative Tarjan lowlink search, fills whichever of the two is asked for
+		void FindCuts(std::vector<int>* pArticulationPoints, std::vector<std::pair<int, int>>* pBridges) const;
+
+		std::vector<bool> m_IsActive;
+		std::vector<int> m_Offsets;
+		std::vector<int> m_Targets;
+		std::vector<int> m_EdgeIds;
+		std::vector<int> m_InDegrees;
+		int m_NrOfEdges = 0;
+		bool m_IsDirectional;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	GraphAnalysis<T_NodeType, T_ConnectionType>::GraphAnalysis(const IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_IsDirectional(pGraph->IsDirectionalGraph())
+	{
+		const int nrOfNodes = pGraph->GetNrOfNodes();
+		m_IsActive.resize(nrOfNodes);
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+			m_IsActive[idx] = pGraph->GetNode(idx)->GetIndex() != invalid_node_index;
+
+		m_Offsets.reserve(nrOfNodes + 1);
+		m_Offsets.push_back(0);
+		m_InDegrees.assign(nrOfNodes, 0);
+
+		// 1. Flat connection lists
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			if (m_IsActive[idx])
+			{
+				for (const auto& pConnection : pGraph->GetNodeConnections(idx))
+				{
+					const int toIdx = pConnection->GetTo();
+					if (!m_IsActive[toIdx])
+						continue;
+
+					m_Targets.push_back(toIdx);
+					++m_InDegrees[toIdx];
+				}
+			}
+			m_Offsets.push_back(int(m_Targets.size()));
+		}
+
+		// 2. Undirected: pair the from -> to half (from < to) of every connection with its to -> from half
+		// The from < to halves are counting sorted on to, then each node looks up the sources of its back halves through
+		// one slot per node instead of hashing node pairs
+		const int nrOfHalves = int(m_Targets.size());
+		std::vector<int> twins(nrOfHalves, -1);
+		if (!m_IsDirectional)
+		{
+			std::vector<int> bucketOffsets(nrOfNodes + 1, 0);
+			for (int idx = 0; idx < nrOfNodes; ++idx)
+			{
+				for (int c = m_Offsets[idx]; c < m_Offsets[idx + 1]; ++c)
+				{
+					if (idx < m_Targets[c])
+						++bucketOffsets[m_Targets[c] + 1];
+				}
+			}
+			for (int idx = 0; idx < nrOfNodes; ++idx)
+				bucketOffsets[idx + 1] += bucketOffsets[idx];
+
+			// Halves into their target's bucket, sources ascending within a bucket
+			std::vector<int> bucketHalves(bucketOffsets[nrOfNodes]);
+			std::vector<int> bucketSources(bucketOffsets[nrOfNodes]);
+			std::vector<int> bucketEnds(bucketOffsets.begin(), bucketOffsets.end() - 1);
+			for (int idx = 0; idx < nrOfNodes; ++idx)
+			{
+				for (int c = m_Offsets[idx]; c < m_Offsets[idx + 1]; ++c)
+				{
+					if (idx < m_Targets[c])
+					{
+						bucketHalves[bucketEnds[m_Targets[c]]] = c;
+						bucketSources[bucketEnds[m_Targets[c]]++] = idx;
+					}
+				}
+			}
+
+			// The half from each source waiting for the current node's back half, a later duplicate replaces an earlier one
+			std::vector<int> waitingHalves(nrOfNodes, -1);
+			for (int idx = 0; idx < nrOfNodes; ++idx)
+			{
+				for (int b = bucketOffsets[idx]; b < bucketOffsets[idx + 1]; ++b)
+					waitingHalves[bucketSources[b]] = bucketHalves[b];
+
+				for (int c = m_Offsets[idx]; c < m_Offsets[idx + 1]; ++c)
+				{
+					const int toIdx = m_Targets[c];
+					if (toIdx < idx && waitingHalves[toIdx] >= 0)
+					{
+						twins[waitingHalves[toIdx]] = c;
+						twins[c] = waitingHalves[toIdx];
+						waitingHalves[toIdx] = -1;
+					}
+				}
+
+				for (int b = bucketOffsets[idx]; b < bucketOffsets[idx + 1]; ++b)
+					waitingHalves[bucketSources[b]] = -1;
+			}
+		}
+
+		// 3. Edge ids in order of the first half, twins share it
+		m_EdgeIds.assign(nrOfHalves, -1);
+		for (int c = 0; c < nrOfHalves; ++c)
+		{
+			if (m_EdgeIds[c] >= 0)
+				continue;
+
+			m_EdgeIds[c] = m_NrOfEdges++;
+			if (twins[c] >= 0)
+				m_EdgeIds[twins[c]] = m_EdgeIds[c];
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_Visit>
+	void GraphAnalysis<T_NodeType, T_ConnectionType>::VisitDFS(int startIdx, T_Visit&& visit) const
+	{
+		// The stack holds each node on the current branch with the next connection to try, the same order a recursive DFS visits in
+		std::vector<bool> visited(GetNrOfNodes(), false);
+		std::vector<std::pair<int, int>> stack{};
+
+		visited[startIdx] = true;
+		visit(startIdx);
+		stack.push_back({ startIdx, m_Offsets[startIdx] });
+		while (!stack.empty())
+		{
+			auto& top = stack.back();
+			if (top.second == m_Offsets[top.first + 1])
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			const int toIdx = m_Targets[top.second++];
+			if (!visited[toIdx])
+			{
+				visited[toIdx] = true;
+				visit(toIdx);
+				stack.push_back({ toIdx, m_Offsets[toIdx] });
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int GraphAnalysis<T_NodeType, T_ConnectionType>::GetNrOfComponents() const
+	{
+		UnionFind sets{ GetNrOfNodes() };
+		int nrOfComponents = 0;
+		for (int idx = 0; idx < GetNrOfNodes(); ++idx)
+		{
+			if (!m_IsActive[idx])
+				continue;
+
+			++nrOfComponents;
+			for (int c = m_Offsets[idx]; c < m_Offsets[idx + 1]; ++c)
+			{
+				if (sets.Union(idx, m_Targets[c]))
+					--nrOfComponents;
+			}
+		}
+		return nrOfComponents;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<int> GraphAnalysis<T_NodeType, T_ConnectionType>::FindArticulationPoints() const
+	{
+		std::vector<int> articulationPoints{};
+		FindCuts(&articulationPoints, nullptr);
+		return articulationPoints;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<std::pair<int, int>> GraphAnalysis<T_NodeType, T_ConnectionType>::FindBridges() const
+	{
+		std::vector<std::pair<int, int>> bridges{};
+		FindCuts(nullptr, &bridges);
+		return bridges;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GraphAnalysis<T_NodeType, T_ConnectionType>::FindCuts(std::vector<int>* pArticulationPoints, std::vector<std::pair<int, int>>* pBridges) const
+	{
+		assert(!m_IsDirectional && "<GraphAnalysis::FindCuts>: articulation points and bridges need an undirected graph");
+
+		// discovery[i] is the DFS order of node i (-1 when not reached yet), low[i] the lowest order reachable from i's
+		// subtree through one connection that isn't the one i was reached by
+		const int nrOfNodes = GetNrOfNodes();
+		std::vector<int> discovery(nrOfNodes, -1);
+		std::vector<int> low(nrOfNodes, 0);
+		std::vector<int> parentEdges(nrOfNodes, -1);
+		std::vector<int> cursors(m_Offsets.begin(), m_Offsets.end() - 1);
+		std::vector<bool> isArticulationPoint(nrOfNodes, false);
+		std::vector<int> stack{};
+
+		int order = 0;
+		for (int rootIdx = 0; rootIdx < nrOfNodes; ++rootIdx)
+		{
+			if (!m_IsActive[rootIdx] || discovery[rootIdx] != -1)
+				continue;
+
+			int nrOfRootChildren = 0;
+			discovery[rootIdx] = low[rootIdx] = order++;
+			stack.push_back(rootIdx);
+			while (!stack.empty())
+			{
+				const int idx = stack.back();
+
+				// 1. Descend into the next connection
+				if (cursors[idx] < m_Offsets[idx + 1])
+				{
+					const int c = cursors[idx]++;
+					if (m_EdgeIds[c] == parentEdges[idx])
+						continue;
+
+					const int toIdx = m_Targets[c];
+					if (discovery[toIdx] == -1)
+					{
+						discovery[toIdx] = low[toIdx] = order++;
+						parentEdges[toIdx] = m_EdgeIds[c];
+						stack.push_back(toIdx);
+						if (idx == rootIdx)
+							++nrOfRootChildren;
+					}
+					else
+					{
+						low[idx] = std::min(low[idx], discovery[toIdx]);
+					}
+					continue;
+				}
+
+				// 2. Done with idx, hand its low to the parent and check the connection between them
+				stack.pop_back();
+				if (stack.empty())
+					break;
+
+				const int parentIdx = stack.back();
+				low[parentIdx] = std::min(low[parentIdx], low[idx]);
+				if (low[idx] > discovery[parentIdx] && pBridges)
+					pBridges->push_back({ parentIdx, idx });
+				if (low[idx] >= discovery[parentIdx] && parentIdx != rootIdx)
+					isArticulationPoint[parentIdx] = true;
+			}
+
+			// 3. The root only splits the graph when the DFS had to leave it more than once
+			if (nrOfRootChildren > 1)
+				isArticulationPoint[rootIdx] = true;
+		}
+
+		if (pArticulationPoints)
+		{
+			for (int idx = 0; idx < nrOfNodes; ++idx)
+			{
+				if (isArticulationPoint[idx])
+					pArticulationPoints->push_back(idx);
+			}
+		}
+	}
+}
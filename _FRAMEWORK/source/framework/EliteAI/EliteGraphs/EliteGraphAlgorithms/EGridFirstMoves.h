@@ -0,0 +1,213 @@
+#pragma once
+#include <assert.h>
+#include <queue>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+
+namespace Elite
+{
+	// Offline building blocks of the tables that are built once for grids that don't change (CompressedPathDatabase,
+	// GoalBounding): the 8 directions a first move is stored as, a Dijkstra that finds every first move of an optimal path
+	// to each cell, the workers that run it from every source cell and the header checks of the table files.
+	template <class T_NodeType, class T_ConnectionType>
+	class GridFirstMoves
+	{
+	public:
+		static constexpr int NrOfDirections = 8;
+		static constexpr uint32_t NoDirection = 0xF;
+
+		// Scratch space of one worker, reused for every source it handles
+		struct Scratch
+		{
+			std::vector<float> distances;
+			// Bit d is set when direction d starts an optimal path to the cell, 0 for the source and cells it can't reach
+			std::vector<uint8_t> directionSets;
+		};
+
+		GridFirstMoves(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Direction of the step between two adjacent cells, NoDirection when they aren't adjacent
+		uint32_t GetDirection(int fromIdx, int toIdx) const;
+		// Cell one step in direction from idx, invalid_node_index if direction isn't one of the 8 or the step leaves the grid
+		int GetNeighborIdx(int idx, uint32_t direction) const;
+
+		// Dijkstra from sourceIdx over the cells an agent of agentSize fits on (see GridGraph::GetClearance), fills scratch
+		// Only connections between adjacent cells start a path, nothing is reached from a source the agent doesn't fit on
+		void FindFirstMoves(int sourceIdx, int agentSize, Scratch& scratch) const;
+		// Calls buildSource(sourceIdx, scratch) once for every cell, nrOfThreads = 0 uses all cores
+		template <class T_BuildSource>
+		void ForEverySource(unsigned int nrOfThreads, const T_BuildSource& buildSource) const;
+
+		// Header of a table file for this grid, with magic, version, size and layout filled in
+		template <class T_Header>
+		T_Header CreateHeader(uint32_t magic, uint32_t version) const;
+		// Header at the start of file, nullptr if the file is too small or was written for another version, grid size or layout
+		template <class T_Header>
+		const T_Header* GetHeader(const MemoryMappedFile& file, uint32_t magic, uint32_t version) const;
+
+	private:
+		// Tables store directions as an index in this table, so they stay valid when the graph is loaded again
+		static constexpr int m_Directions[NrOfDirections][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+		uint32_t GetLayoutFlags() const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	GridFirstMoves<T_NodeType, T_ConnectionType>::GridFirstMoves(GridGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	uint32_t GridFirstMoves<T_NodeType, T_ConnectionType>::GetDirection(int fromIdx, int toIdx) const
+	{
+		int fromCol, fromRow, toCol, toRow;
+		m_pGraph->GetColRow(fromIdx, fromCol, fromRow);
+		m_pGraph->GetColRow(toIdx, toCol, toRow);
+
+		for (uint32_t d = 0; d < NrOfDirections; ++d)
+		{
+			if (fromCol + m_Directions[d][0] == toCol && fromRow + m_Directions[d][1] == toRow)
+				return d;
+		}
+		return NoDirection;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int GridFirstMoves<T_NodeType, T_ConnectionType>::GetNeighborIdx(int idx, uint32_t direction) const
+	{
+		if (direction >= NrOfDirections)
+			return invalid_node_index;
+
+		int col, row;
+		m_pGraph->GetColRow(idx, col, row);
+		col += m_Directions[direction][0];
+		row += m_Directions[direction][1];
+		return m_pGraph->IsWithinBounds(col, row) ? m_pGraph->GetIndex(col, row) : invalid_node_index;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GridFirstMoves<T_NodeType, T_ConnectionType>::FindFirstMoves(int sourceIdx, int agentSize, Scratch& scratch) const
+	{
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		scratch.distances.assign(nrOfNodes, std::numeric_limits<float>::max());
+		scratch.directionSets.assign(nrOfNodes, 0);
+
+		if (!m_pGraph->CanFitAgent(sourceIdx, agentSize))
+			return;
+
+		using QueueEntry = std::pair<float, int>;
+		std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> openList{};
+
+		scratch.distances[sourceIdx] = 0.f;
+		openList.push({ 0.f, sourceIdx });
+
+		while (!openList.empty())
+		{
+			const float distance = openList.top().first;
+			const int idx = openList.top().second;
+			openList.pop();
+
+			// Outdated entry, the node was reached cheaper before
+			if (distance > scratch.distances[idx])
+				continue;
+
+			for (auto pConnection : m_pGraph->GetConnections(idx))
+			{
+				const int toIdx = pConnection->GetTo();
+				if (!m_pGraph->CanFitAgent(toIdx, agentSize))
+					continue;
+
+				const float toDistance = distance + pConnection->GetCost();
+				if (toDistance > scratch.distances[toIdx])
+					continue;
+
+				// Nodes inherit the directions of every node they are reached through at the same cost
+				// (grid costs are multiples of 0.5, so equal costs compare exactly)
+				uint8_t directions = scratch.directionSets[idx];
+				if (idx == sourceIdx)
+				{
+					const uint32_t direction = GetDirection(idx, toIdx);
+					if (direction == NoDirection)
+						continue;
+					directions = uint8_t(1 << direction);
+				}
+
+				if (toDistance < scratch.distances[toIdx])
+				{
+					scratch.distances[toIdx] = toDistance;
+					scratch.directionSets[toIdx] = directions;
+					openList.push({ toDistance, toIdx });
+				}
+				else
+				{
+					scratch.directionSets[toIdx] |= directions;
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_BuildSource>
+	void GridFirstMoves<T_NodeType, T_ConnectionType>::ForEverySource(unsigned int nrOfThreads, const T_BuildSource& buildSource) const
+	{
+		if (nrOfThreads == 0)
+			nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// Workers take the next source until all are done
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		std::atomic<int> nextSourceIdx{ 0 };
+		auto worker = [&]()
+		{
+			Scratch scratch{};
+			for (int sourceIdx = nextSourceIdx++; sourceIdx < nrOfNodes; sourceIdx = nextSourceIdx++)
+				buildSource(sourceIdx, scratch);
+		};
+
+		std::vector<std::thread> threads{};
+		for (unsigned int i = 1; i < nrOfThreads; ++i)
+			threads.emplace_back(worker);
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_Header>
+	T_Header GridFirstMoves<T_NodeType, T_ConnectionType>::CreateHeader(uint32_t magic, uint32_t version) const
+	{
+		T_Header header{};
+		header.magic = magic;
+		header.version = version;
+		header.columns = m_pGraph->GetColumns();
+		header.rows = m_pGraph->GetRows();
+		header.flags = GetLayoutFlags();
+		return header;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_Header>
+	const T_Header* GridFirstMoves<T_NodeType, T_ConnectionType>::GetHeader(const MemoryMappedFile& file, uint32_t magic, uint32_t version) const
+	{
+		const T_Header* pHeader = file.GetAt<T_Header>(0);
+		if (pHeader == nullptr
+			|| pHeader->magic != magic
+			|| pHeader->version != version
+			|| pHeader->columns != m_pGraph->GetColumns()
+			|| pHeader->rows != m_pGraph->GetRows()
+			|| pHeader->flags != GetLayoutFlags())
+			return nullptr;
+
+		return pHeader;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	uint32_t GridFirstMoves<T_NodeType, T_ConnectionType>::GetLayoutFlags() const
+	{
+		return m_pGraph->GetLayout() == GridLayout::Tiled ? GraphFileFormat::GridFlag_TiledLayout : 0;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <assert.h>
 #include <memory>
+#include "EGoalBounding.h"
 
 namespace Elite
 {
@@ -31,15 +32,23 @@ namespace Elite
 			};
 		};
 
-		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Cells an agent of agentSize doesn't fit on (see GridGraph::GetClearance) are treated as obstacles
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, int agentSize = 1);
+
+		// Neighbours the goal bounds rule out aren't jumped to, only for the agent size the bounds were built for (nullptr turns it off)
+		void SetGoalBounding(const GoalBounding<T_NodeType, T_ConnectionType>* pGoalBounding) { m_pGoalBounding = pGoalBounding; }
 
 	private:
 		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
 		std::vector<std::shared_ptr<NodeRecord>> IdentifySuccessors(std::shared_ptr<NodeRecord> pCurrentNode, T_NodeType* pStartNode, T_NodeType* pGoalNode);
 		std::shared_ptr<NodeRecord> Jump(std::shared_ptr<NodeRecord> pCurrentNode, const Elite::Vector2& difference, T_NodeType* pStartNode, T_NodeType* pGoalNode);
 
+		bool IsTraversable(int idx) const { return m_pGraph->CanFitAgent(idx, m_AgentSize); }
+
 		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
 		Heuristic m_HeuristicFunction;
+		int m_AgentSize = 1;
+		const GoalBounding<T_NodeType, T_ConnectionType>* m_pGoalBounding = nullptr;
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
@@ -64,6 +73,10 @@ namespace Elite
 			int nodeIdx = pConnection->GetTo();
 			T_NodeType* pNeighborNode = m_pGraph->GetNode(nodeIdx);
 
+			if (m_pGoalBounding != nullptr && m_pGoalBounding->GetAgentSize() == m_AgentSize
+				&& !m_pGoalBounding->IsEdgeUseful(pCurrentNode->pNode->GetIndex(), nodeIdx, pGoalNode->GetIndex()))
+				continue;
+
 			Elite::Vector2 neighborNodePos = m_pGraph->GetNodeWorldPos(pNeighborNode);
 			Elite::Vector2 currentNodePos = m_pGraph->GetNodeWorldPos(pCurrentNode->pNode);
 
@@ -88,7 +101,7 @@ namespace Elite
 		if (pNextNode == nullptr)
 			return nullptr;
 
-		if (pNextNode->GetTerrainType() == TerrainType::Water)
+		if (!IsTraversable(pNextNode->GetIndex()))
 			return nullptr;
 
 		NodeRecord nextJumpNR{};
@@ -105,8 +118,8 @@ namespace Elite
 		if (!Elite::AreEqual(difference.x, 0.f) && !Elite::AreEqual(difference.y, 0.f)) // Diagonal Case
 		{
 			// if(current.x + x == obstacle || current.y + y == obstacle) return next
-			if (m_pGraph->GetNodeAtWorldPos({ currentNodePos.x + difference.x, currentNodePos.y })->GetTerrainType() == TerrainType::Water
-			 || m_pGraph->GetNodeAtWorldPos({ currentNodePos.x, currentNodePos.y + difference.y })->GetTerrainType() == TerrainType::Water)
+			if (!IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x + difference.x, currentNodePos.y }))
+			 || !IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x, currentNodePos.y + difference.y })))
 				return pNextJumpNR;
 
 			// Check horizontal and vertical directions for forced neighbors
@@ -121,57 +134,57 @@ namespace Elite
 		}
 		else if (!Elite::AreEqual(difference.x, 0.f)) // Horizontal Case
 		{
-			int idx{};
-			int nrCols = m_pGraph->GetColumns();
-			
-			idx = pCurrentNode->pNode->GetIndex() + nrCols;
-			if (m_pGraph->IsNodeValid(idx))
+			int col, row;
+			m_pGraph->GetColRow(pCurrentNode->pNode->GetIndex(), col, row);
+
+			if (m_pGraph->IsWithinBounds(col, row + 1))
 			{
+				int idx = m_pGraph->GetIndex(col, row + 1);
 				float nodeUp = m_pGraph->GetNodeWorldPos(idx).y;
 				// if (current.y + 1 == obstacle) && if (current.x + x, current.y + 1 != obstacle)
-				if (m_pGraph->GetNodeAtWorldPos({ currentNodePos.x, nodeUp })->GetTerrainType() == TerrainType::Water
-				 && m_pGraph->GetNodeAtWorldPos({ currentNodePos.x + difference.x, nodeUp })->GetTerrainType() != TerrainType::Water)
+				if (!IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x, nodeUp }))
+				 && IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x + difference.x, nodeUp })))
 					return pNextJumpNR;
 			}
 
-			idx = pCurrentNode->pNode->GetIndex() - nrCols;
-			if (m_pGraph->IsNodeValid(idx) && idx >= 0)
+			if (m_pGraph->IsWithinBounds(col, row - 1))
 			{
+				int idx = m_pGraph->GetIndex(col, row - 1);
 				float nodeDown = m_pGraph->GetNodeWorldPos(idx).y;
 				// else if (current.y - 1 == obstacle) && if (current.x + x, current.y - 1 != obstacle)
-				if (m_pGraph->GetNodeAtWorldPos({ currentNodePos.x, nodeDown })->GetTerrainType() == TerrainType::Water
-				 && m_pGraph->GetNodeAtWorldPos({ currentNodePos.x + difference.x, nodeDown })->GetTerrainType() != TerrainType::Water)
+				if (!IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x, nodeDown }))
+				 && IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ currentNodePos.x + difference.x, nodeDown })))
 					return pNextJumpNR;
 			}
 		}
 		else  //Vertical Case
 		{
-			int idx{};
-			int nrRows = m_pGraph->GetRows();
+			int col, row;
+			m_pGraph->GetColRow(pCurrentNode->pNode->GetIndex(), col, row);
 
 			// need to check node left and node right if valid 
 			// but node + difference will be valid because they are checked in successors
-			idx = pCurrentNode->pNode->GetIndex() + 1;
-			if (m_pGraph->IsNodeValid(idx) && (int(idx / nrRows) == int(pCurrentNode->pNode->GetIndex() / nrRows)))
+			if (m_pGraph->IsWithinBounds(col + 1, row))
 			{
+				int idx = m_pGraph->GetIndex(col + 1, row);
 				float nodeLeft = m_pGraph->GetNodeWorldPos(idx).x;
 
 				// if (current.x + 1 == obstacle) && if (current.x + 1, current.y + y != obstacle)
 				// return next
-				if (m_pGraph->GetNodeAtWorldPos({ nodeLeft, currentNodePos.y })->GetTerrainType() == TerrainType::Water
-				 && m_pGraph->GetNodeAtWorldPos({ nodeLeft, currentNodePos.y + difference.y })->GetTerrainType() != TerrainType::Water)
+				if (!IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ nodeLeft, currentNodePos.y }))
+				 && IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ nodeLeft, currentNodePos.y + difference.y })))
 					return pNextJumpNR;
 			}
 
-			idx = pCurrentNode->pNode->GetIndex() - 1;
-			if (m_pGraph->IsNodeValid(idx) && idx >= 0 && (int(idx / nrRows) == int(pCurrentNode->pNode->GetIndex() / nrRows)))
+			if (m_pGraph->IsWithinBounds(col - 1, row))
 			{
+				int idx = m_pGraph->GetIndex(col - 1, row);
 				float nodeRight = m_pGraph->GetNodeWorldPos(idx).x;
 
 				// else if (current.x - 1 == obstacle) && if (current.x - 1, current.y + y != obstacle)
 					// return next
-				if (m_pGraph->GetNodeAtWorldPos({ nodeRight, currentNodePos.y })->GetTerrainType() == TerrainType::Water
-				 && m_pGraph->GetNodeAtWorldPos({ nodeRight, currentNodePos.y + difference.y })->GetTerrainType() != TerrainType::Water)
+				if (!IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ nodeRight, currentNodePos.y }))
+				 && IsTraversable(m_pGraph->GetNodeIdxAtWorldPos({ nodeRight, currentNodePos.y + difference.y })))
 					return pNextJumpNR;
 			}
 		}
@@ -181,12 +194,21 @@ namespace Elite
 	}
 
 	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> JPS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	std::vector<T_NodeType*> JPS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, int agentSize)
 	{
+		m_AgentSize = agentSize;
+
 		std::vector<T_NodeType*> path{};
 		std::vector<std::shared_ptr<NodeRecord>> openList{};
 		std::vector<std::shared_ptr<NodeRecord>> closedList{};
 
+		// Unreachable goals are rejected without flooding the whole component
+		if (!m_pGraph->AreConnected(pStartNode->GetIndex(), pGoalNode->GetIndex()))
+			return path;
+
+		if (!IsTraversable(pStartNode->GetIndex()) || !IsTraversable(pGoalNode->GetIndex()))
+			return path;
+
 		// Start node to add to open list
 		NodeRecord tempRecord{};
 		tempRecord.pNode = pStartNode;
@@ -0,0 +1,81 @@
+#pragma once
+#include <assert.h>
+#include <limits>
+#include "EAStar.h"
+
+namespace Elite
+{
+	// Dijkstra from one start node that stops at the first (so the nearest) node of a target set
+	// Answers "closest X" queries over the graph in one search, instead of one A* per candidate or a straight line
+	// distance that ignores obstacles. Targets are given as a marked-node vector (indexed on node index) or as a
+	// predicate on the node index, e.g. to test the cells food lies on. Runs AStarSearch with a heuristic of 0.
+	template <class T_NodeType, class T_ConnectionType>
+	class MultiTargetDijkstra
+	{
+	public:
+		MultiTargetDijkstra(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Returns the path to the nearest target (empty if none is reachable within maxCost),
+		// foundTargetIdx and pathCost are set to that target's node index and cost (invalid_node_index and 0 otherwise)
+		template <class T_IsTarget>
+		std::vector<T_NodeType*> FindPathToNearest(T_NodeType* pStartNode, T_IsTarget isTarget, int& foundTargetIdx, float& pathCost,
+			float maxCost = std::numeric_limits<float>::max(), int agentSize = 1);
+		std::vector<T_NodeType*> FindPathToNearest(T_NodeType* pStartNode, const std::vector<bool>& isTarget, int& foundTargetIdx, float& pathCost,
+			float maxCost = std::numeric_limits<float>::max(), int agentSize = 1);
+
+	private:
+		static float NoHeuristic(float, float) { return 0.f; }
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+
+		// The search keeps its per node state between queries to not reallocate, the view is set to each query's agent size
+		IGraphView<T_NodeType, T_ConnectionType> m_View;
+		AStarSearch<IGraphView<T_NodeType, T_ConnectionType>> m_Search;
+
+		//C++ make the class non-copyable, the search points at the view
+		MultiTargetDijkstra(const MultiTargetDijkstra&) = delete;
+		MultiTargetDijkstra& operator=(const MultiTargetDijkstra&) = delete;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	MultiTargetDijkstra<T_NodeType, T_ConnectionType>::MultiTargetDijkstra(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+		, m_View(pGraph)
+		, m_Search(&m_View, NoHeuristic)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> MultiTargetDijkstra<T_NodeType, T_ConnectionType>::FindPathToNearest(T_NodeType* pStartNode, const std::vector<bool>& isTarget,
+		int& foundTargetIdx, float& pathCost, float maxCost, int agentSize)
+	{
+		assert(int(isTarget.size()) == m_pGraph->GetNrOfNodes() && "<MultiTargetDijkstra::FindPathToNearest>: target vector has to hold one entry per node");
+
+		return FindPathToNearest(pStartNode, [&isTarget](int idx) { return bool(isTarget[idx]); }, foundTargetIdx, pathCost, maxCost, agentSize);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_IsTarget>
+	std::vector<T_NodeType*> MultiTargetDijkstra<T_NodeType, T_ConnectionType>::FindPathToNearest(T_NodeType* pStartNode, T_IsTarget isTarget,
+		int& foundTargetIdx, float& pathCost, float maxCost, int agentSize)
+	{
+		std::vector<T_NodeType*> path{};
+		foundTargetIdx = invalid_node_index;
+		pathCost = 0.f;
+
+		const int startIdx = pStartNode->GetIndex();
+		if (!m_pGraph->CanFitAgent(startIdx, agentSize))
+			return path;
+
+		// Nodes are closed in order of cost, so the first target closed is the nearest one
+		m_View = IGraphView<T_NodeType, T_ConnectionType>{ m_pGraph, agentSize };
+		m_Search.SetMaxCost(maxCost);
+		m_Search.Start(startIdx, startIdx);
+		m_Search.Expand(std::numeric_limits<int>::max(), isTarget);
+
+		foundTargetIdx = m_Search.GetFoundIdx();
+		for (int idx : m_Search.GetPath(&pathCost))
+			path.push_back(m_pGraph->GetNode(idx));
+		return path;
+	}
+}
@@ -0,0 +1,307 @@
+#pragma once
+#include <assert.h>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "framework\EliteHelpers\ESpinBarrier.h"
+
+namespace Elite
+{
+	// Direction-optimizing parallel BFS (Beamer et al.) for large floods: hop distances from one or more sources
+	// Build snapshots the graph's connections as CSR arrays (and the reversed ones for directional graphs).
+	// Every level either pushes from the frontier (top-down, visited cells claimed with atomic bitset updates) or, once
+	// the frontier's edges outnumber what is left to explore, lets every unvisited node look for a parent in the frontier
+	// (bottom-up, no atomics needed). Depths give reachability, step counts for flow fields and, run per seed, components.
+	// The snapshot has to be rebuilt after the graph changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class ParallelBFS
+	{
+	public:
+		ParallelBFS(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		void Build();
+		bool IsBuilt() const { return !m_Offsets.empty(); }
+
+		struct Stats
+		{
+			int nrOfLevels = 0;
+			int nrOfBottomUpLevels = 0;
+			long long nrOfTraversedEdges = 0; // edges looked at, both directions
+			double seconds = 0.0;
+
+			double GetEdgesPerSecond() const { return seconds > 0.0 ? nrOfTraversedEdges / seconds : 0.0; }
+		};
+
+		// Fills depths with the number of steps from the nearest source, -1 when unreachable
+		// nrOfThreads = 0 uses all cores, allowBottomUp = false gives a plain (parallel) top-down BFS
+		void Run(const std::vector<int>& sources, std::vector<int>& depths, unsigned int nrOfThreads = 0, bool allowBottomUp = true);
+		const Stats& GetLastStats() const { return m_LastStats; }
+
+		// Switch thresholds from the paper: bottom-up when the frontier's edges exceed the unexplored ones / Alpha,
+		// back to top-down when the frontier has fewer than nrOfNodes / Beta nodes
+		static constexpr int Alpha = 14;
+		static constexpr int Beta = 24;
+
+	private:
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+
+		// Connections of node i are m_Targets[m_Offsets[i] .. m_Offsets[i + 1]], incoming ones the same in m_In*
+		// (only filled for directional graphs, undirected ones use the outgoing arrays)
+		std::vector<int> m_Offsets;
+		std::vector<int> m_Targets;
+		std::vector<int> m_InOffsets;
+		std::vector<int> m_InSources;
+
+		Stats m_LastStats{};
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	ParallelBFS<T_NodeType, T_ConnectionType>::ParallelBFS(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void ParallelBFS<T_NodeType, T_ConnectionType>::Build()
+	{
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+
+		m_Offsets.assign(1, 0);
+		m_Targets.clear();
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			if (m_pGraph->IsNodeValid(idx))
+			{
+				for (const auto& pConnection : m_pGraph->GetNodeConnections(idx))
+					m_Targets.push_back(pConnection->GetTo());
+			}
+			m_Offsets.push_back(int(m_Targets.size()));
+		}
+
+		m_InOffsets.clear();
+		m_InSources.clear();
+		if (!m_pGraph->IsDirectionalGraph())
+			return;
+
+		// Counting sort of the connections on their target
+		m_InOffsets.assign(nrOfNodes + 1, 0);
+		for (int target : m_Targets)
+			++m_InOffsets[target + 1];
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+			m_InOffsets[idx + 1] += m_InOffsets[idx];
+
+		std::vector<int> insertAt(m_InOffsets.begin(), m_InOffsets.end() - 1);
+		m_InSources.resize(m_Targets.size());
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			for (int e = m_Offsets[idx]; e < m_Offsets[idx + 1]; ++e)
+				m_InSources[insertAt[m_Targets[e]]++] = idx;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void ParallelBFS<T_NodeType, T_ConnectionType>::Run(const std::vector<int>& sources, std::vector<int>& depths, unsigned int nrOfThreads, bool allowBottomUp)
+	{
+		assert(IsBuilt() && "<ParallelBFS::Run>: Build has to be called first");
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+
+		if (nrOfThreads == 0)
+			nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		const int nrOfNodes = int(m_Offsets.size()) - 1;
+		const int nrOfWords = (nrOfNodes + 63) / 64;
+		const std::vector<int>& inOffsets = m_InOffsets.empty() ? m_Offsets : m_InOffsets;
+		const std::vector<int>& inSources = m_InSources.empty() ? m_Targets : m_InSources;
+
+		depths.assign(nrOfNodes, -1);
+		m_LastStats = {};
+
+		// 1. Shared level state, only worker 0 changes it (between the barriers)
+		std::unique_ptr<std::atomic<uint64_t>[]> visited{ new std::atomic<uint64_t>[nrOfWords] };
+		for (int w = 0; w < nrOfWords; ++w)
+			visited[w].store(0, std::memory_order_relaxed);
+
+		std::vector<int> frontier{};
+		std::vector<uint64_t> frontierBits(nrOfWords, 0);
+		std::vector<uint64_t> nextFrontierBits(nrOfWords, 0);
+		std::vector<std::vector<int>> nextFrontiers(nrOfThreads);
+		std::vector<long long> traversedEdges(nrOfThreads, 0);
+
+		for (int sourceIdx : sources)
+		{
+			if (sourceIdx < 0 || sourceIdx >= nrOfNodes || depths[sourceIdx] == 0)
+				continue;
+
+			depths[sourceIdx] = 0;
+			visited[sourceIdx / 64].fetch_or(uint64_t(1) << (sourceIdx % 64), std::memory_order_relaxed);
+			frontier.push_back(sourceIdx);
+		}
+
+		// Out edges of the nodes not reached yet, and the number of nodes on the current level in either representation
+		long long unexploredEdges = m_Targets.size();
+		for (int idx : frontier)
+			unexploredEdges -= m_Offsets[idx + 1] - m_Offsets[idx];
+		int frontierSize = int(frontier.size());
+		bool isBottomUp = false;
+		bool isDone = frontier.empty();
+		int depth = 0;
+
+		SpinBarrier barrier{ int(nrOfThreads) };
+
+		auto worker = [&](unsigned int threadIdx)
+		{
+			while (true)
+			{
+				barrier.Wait();
+				if (isDone)
+					return;
+
+				long long& edges = traversedEdges[threadIdx];
+				if (!isBottomUp)
+				{
+					// 2.a Top-down: push from this worker's slice of the frontier, claim nodes with an atomic or
+					std::vector<int>& next = nextFrontiers[threadIdx];
+					next.clear();
+
+					const size_t begin = size_t(int64_t(frontierSize) * threadIdx / nrOfThreads);
+					const size_t end = size_t(int64_t(frontierSize) * (threadIdx + 1) / nrOfThreads);
+					for (size_t i = begin; i < end; ++i)
+					{
+						const int idx = frontier[i];
+						edges += m_Offsets[idx + 1] - m_Offsets[idx];
+						for (int e = m_Offsets[idx]; e < m_Offsets[idx + 1]; ++e)
+						{
+							const int toIdx = m_Targets[e];
+							const uint64_t bit = uint64_t(1) << (toIdx % 64);
+							if (visited[toIdx / 64].load(std::memory_order_relaxed) & bit)
+								continue;
+							if (visited[toIdx / 64].fetch_or(bit, std::memory_order_relaxed) & bit)
+								continue;
+
+							depths[toIdx] = depth + 1;
+							next.push_back(toIdx);
+						}
+					}
+				}
+				else
+				{
+					// 2.b Bottom-up: every unvisited node of this worker's words looks for a parent in the frontier,
+					// words aren't shared between workers so the bitsets are written without contention
+					const int beginWord = int(int64_t(nrOfWords) * threadIdx / nrOfThreads);
+					const int endWord = int(int64_t(nrOfWords) * (threadIdx + 1) / nrOfThreads);
+					for (int w = beginWord; w < endWord; ++w)
+					{
+						uint64_t visitedWord = visited[w].load(std::memory_order_relaxed);
+						uint64_t nextWord = 0;
+						for (int bit = 0; bit < 64; ++bit)
+						{
+							const int idx = w * 64 + bit;
+							if (idx >= nrOfNodes || (visitedWord & (uint64_t(1) << bit)))
+								continue;
+
+							for (int e = inOffsets[idx]; e < inOffsets[idx + 1]; ++e)
+							{
+								++edges;
+								const int fromIdx = inSources[e];
+								if (frontierBits[fromIdx / 64] & (uint64_t(1) << (fromIdx % 64)))
+								{
+									depths[idx] = depth + 1;
+									nextWord |= uint64_t(1) << bit;
+									break;
+								}
+							}
+						}
+						visited[w].store(visitedWord | nextWord, std::memory_order_relaxed);
+						nextFrontierBits[w] = nextWord;
+					}
+				}
+
+				barrier.Wait();
+				if (threadIdx != 0)
+					continue;
+
+				// 3. Worker 0 gathers the next frontier and picks the direction of the next level
+				long long frontierEdges = 0;
+				int nextFrontierSize = 0;
+				if (!isBottomUp)
+				{
+					frontier.clear();
+					for (const auto& next : nextFrontiers)
+						frontier.insert(frontier.end(), next.begin(), next.end());
+					nextFrontierSize = int(frontier.size());
+					for (int idx : frontier)
+						frontierEdges += m_Offsets[idx + 1] - m_Offsets[idx];
+				}
+				else
+				{
+					frontierBits.swap(nextFrontierBits);
+					for (int w = 0; w < nrOfWords; ++w)
+					{
+						nextFrontierSize += int(std::bitset<64>(frontierBits[w]).count());
+						for (uint64_t word = frontierBits[w]; word != 0; word &= word - 1)
+						{
+							int bit = 0;
+							while ((word & (uint64_t(1) << bit)) == 0)
+								++bit;
+							const int idx = w * 64 + bit;
+							frontierEdges += m_Offsets[idx + 1] - m_Offsets[idx];
+						}
+					}
+				}
+				unexploredEdges -= frontierEdges;
+
+				++depth;
+				isDone = nextFrontierSize == 0;
+				if (isDone)
+					continue;
+
+				const bool wasBottomUp = isBottomUp;
+				if (!isBottomUp)
+					isBottomUp = allowBottomUp && frontierEdges > unexploredEdges / Alpha && nextFrontierSize > frontierSize;
+				else
+					isBottomUp = !(nextFrontierSize < nrOfNodes / Beta && nextFrontierSize < frontierSize);
+				frontierSize = nextFrontierSize;
+
+				// Switching directions converts the frontier between list and bitset
+				if (isBottomUp && !wasBottomUp)
+				{
+					std::fill(frontierBits.begin(), frontierBits.end(), 0);
+					for (int idx : frontier)
+						frontierBits[idx / 64] |= uint64_t(1) << (idx % 64);
+				}
+				else if (!isBottomUp && wasBottomUp)
+				{
+					frontier.clear();
+					for (int w = 0; w < nrOfWords; ++w)
+					{
+						for (uint64_t word = frontierBits[w]; word != 0; word &= word - 1)
+						{
+							int bit = 0;
+							while ((word & (uint64_t(1) << bit)) == 0)
+								++bit;
+							frontier.push_back(w * 64 + bit);
+						}
+					}
+				}
+
+				if (isBottomUp)
+					++m_LastStats.nrOfBottomUpLevels;
+			}
+		};
+
+		std::vector<std::thread> threads{};
+		for (unsigned int i = 1; i < nrOfThreads; ++i)
+			threads.emplace_back(worker, i);
+		worker(0);
+		for (auto& thread : threads)
+			thread.join();
+
+		m_LastStats.nrOfLevels = depth;
+		for (long long edges : traversedEdges)
+			m_LastStats.nrOfTraversedEdges += edges;
+		m_LastStats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+}
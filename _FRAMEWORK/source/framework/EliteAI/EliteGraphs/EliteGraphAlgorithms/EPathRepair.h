@@ -0,0 +1,154 @@
+#pragma once
+#include <assert.h>
+#include <limits>
+#include <unordered_map>
+#include "EAStar.h"
+
+namespace Elite
+{
+	// Fixes a path after the graph changed instead of replanning it from the agent's position
+	// The broken section is the stretch between the last waypoint before the first blocked node or removed connection and
+	// the first waypoint after which the path is intact again. A bounded local A* reconnects the two; it may also join the
+	// intact part further along, when the new obstacle reaches past it. Only when that fails within the expansion budget
+	// the whole remaining path is replanned. Repaired paths stay valid, they aren't guaranteed to be optimal any more.
+	template <class T_NodeType, class T_ConnectionType>
+	class PathRepair
+	{
+	public:
+		enum class RepairResult
+		{
+			Unchanged, // nothing on the path was affected
+			Repaired, // a local search reconnected the path
+			Replanned, // the local search failed, the rest of the path was planned again
+			Failed // the goal can't be reached any more, the path is cleared
+		};
+
+		PathRepair(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int maxLocalExpansions = 512);
+
+		void SetMaxLocalExpansions(int maxExpansions) { m_MaxLocalExpansions = maxExpansions; }
+
+		// currentWaypoint is the index of the waypoint the agent is on (or walking away from), nothing before it is checked
+		// or kept in a replan, so an agent can keep its iterator into the path as long as the result isn't Replanned or Failed
+		RepairResult Repair(std::vector<T_NodeType*>& path, size_t currentWaypoint = 0, int agentSize = 1);
+
+		// Nodes expanded by the last Repair, local search and replan together
+		int GetLastNrOfExpandedNodes() const { return m_LastNrOfExpandedNodes; }
+
+	private:
+		bool IsStepValid(T_NodeType* pFrom, T_NodeType* pTo, int agentSize) const;
+		// Bounded A* from startIdx to any waypoint from rejoinWaypoint on, returns the waypoint it joined (or -1) and the nodes in between
+		int FindLocalDetour(const std::vector<T_NodeType*>& path, size_t startWaypoint, size_t rejoinWaypoint, int agentSize, std::vector<int>& detour);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_MaxLocalExpansions;
+		int m_LastNrOfExpandedNodes = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRepair<T_NodeType, T_ConnectionType>::PathRepair(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int maxLocalExpansions)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_MaxLocalExpansions(maxLocalExpansions)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename PathRepair<T_NodeType, T_ConnectionType>::RepairResult PathRepair<T_NodeType, T_ConnectionType>::Repair(std::vector<T_NodeType*>& path,
+		size_t currentWaypoint, int agentSize)
+	{
+		assert(currentWaypoint < path.size() && "<PathRepair::Repair>: current waypoint isn't on the path");
+		m_LastNrOfExpandedNodes = 0;
+
+		// 1. Find the broken section: steps firstBroken -> firstBroken + 1 up to lastBroken -> lastBroken + 1
+		const size_t nrOfSteps = path.size() - 1;
+		size_t firstBroken = nrOfSteps;
+		size_t lastBroken = nrOfSteps;
+		for (size_t i = currentWaypoint; i < nrOfSteps; ++i)
+		{
+			if (!IsStepValid(path[i], path[i + 1], agentSize))
+			{
+				if (firstBroken == nrOfSteps)
+					firstBroken = i;
+				lastBroken = i;
+			}
+		}
+
+		if (firstBroken == nrOfSteps)
+			return RepairResult::Unchanged;
+
+		// 2. Reconnect the waypoint before the first broken step with the intact rest of the path
+		// (an agent standing on a blocked node can't be helped locally)
+		if (m_pGraph->CanFitAgent(path[firstBroken]->GetIndex(), agentSize))
+		{
+			std::vector<int> detour{};
+			const int joinedWaypoint = FindLocalDetour(path, firstBroken, lastBroken + 1, agentSize, detour);
+			if (joinedWaypoint >= 0)
+			{
+				std::vector<T_NodeType*> repairedPath(path.begin(), path.begin() + firstBroken + 1);
+				for (int idx : detour)
+					repairedPath.push_back(m_pGraph->GetNode(idx));
+				repairedPath.insert(repairedPath.end(), path.begin() + joinedWaypoint, path.end());
+
+				path = std::move(repairedPath);
+				return RepairResult::Repaired;
+			}
+		}
+
+		// 3. Escalate to a full replan of everything from the current waypoint on
+		const IGraphView<T_NodeType, T_ConnectionType> view{ m_pGraph, agentSize };
+		AStar<IGraphView<T_NodeType, T_ConnectionType>> pathfinder{ &view, m_HeuristicFunction };
+		std::vector<T_NodeType*> newPath = pathfinder.FindPath(path[currentWaypoint], path.back());
+		m_LastNrOfExpandedNodes += pathfinder.GetLastSearchStats().nrOfExpandedNodes;
+
+		if (newPath.empty())
+		{
+			path.clear();
+			return RepairResult::Failed;
+		}
+
+		path.resize(currentWaypoint);
+		path.insert(path.end(), newPath.begin(), newPath.end());
+		return RepairResult::Replanned;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool PathRepair<T_NodeType, T_ConnectionType>::IsStepValid(T_NodeType* pFrom, T_NodeType* pTo, int agentSize) const
+	{
+		const int toIdx = pTo->GetIndex();
+		return m_pGraph->IsNodeValid(toIdx)
+			&& m_pGraph->CanFitAgent(toIdx, agentSize)
+			&& m_pGraph->GetConnection(pFrom->GetIndex(), toIdx) != nullptr;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int PathRepair<T_NodeType, T_ConnectionType>::FindLocalDetour(const std::vector<T_NodeType*>& path, size_t startWaypoint, size_t rejoinWaypoint,
+		int agentSize, std::vector<int>& detour)
+	{
+		// Waypoints the detour may join, the last one counts if a node is on the path twice
+		std::unordered_map<int, int> joinWaypoints{};
+		for (size_t i = rejoinWaypoint; i < path.size(); ++i)
+			joinWaypoints[path[i]->GetIndex()] = int(i);
+
+		// The search aims for the rejoin waypoint, that keeps it local. Per node state is hashed, a local search only
+		// touches a few nodes so clearing arrays the size of the graph would cost more than the search itself.
+		const int startIdx = path[startWaypoint]->GetIndex();
+		const IGraphView<T_NodeType, T_ConnectionType> view{ m_pGraph, agentSize };
+		AStarSearch<IGraphView<T_NodeType, T_ConnectionType>, float, HashedSearchRecords<float>> search{ &view, m_HeuristicFunction };
+		search.Start(startIdx, path[rejoinWaypoint]->GetIndex());
+		search.Expand(m_MaxLocalExpansions, [&joinWaypoints](int idx) { return joinWaypoints.find(idx) != joinWaypoints.end(); });
+		m_LastNrOfExpandedNodes += search.GetNrOfExpandedNodes();
+
+		const int joinedIdx = search.GetFoundIdx();
+		if (joinedIdx == invalid_node_index)
+			return -1;
+
+		// Nodes strictly between the start and the joined waypoint
+		const std::vector<int> localPath = search.GetPath();
+		detour.clear();
+		if (localPath.size() > 1)
+			detour.assign(localPath.begin() + 1, localPath.end() - 1);
+
+		return joinWaypoints[joinedIdx];
+	}
+}
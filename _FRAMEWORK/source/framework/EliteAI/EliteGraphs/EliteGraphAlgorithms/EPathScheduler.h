@@ -0,0 +1,249 @@
+#pragma once
+#include <assert.h>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include "EAStar.h"
+
+namespace Elite
+{
+	// Spreads path requests over frames: Update runs the pending A* searches until the frame's time budget is used up
+	// and continues them in later frames where they left off. The most urgent request is worked on first: requests due
+	// this frame, then the highest priority (which grows the longer a request waits, so low priorities can't starve),
+	// then the earliest deadline, then the oldest. Works on any graph view (see EGraphViews.h), paths are node indices.
+	template <class T_GraphView>
+	class PathScheduler
+	{
+	public:
+		using RequestId = int;
+		static constexpr RequestId InvalidRequest = -1;
+		static constexpr int NoDeadline = std::numeric_limits<int>::max();
+
+		enum class RequestStatus
+		{
+			Unknown, // never requested, cancelled or already taken
+			Pending,
+			Done,
+			Failed // goal unreachable
+		};
+
+		// agingPerFrame is added to a waiting request's priority every frame
+		PathScheduler(const T_GraphView* pGraph, Heuristic hFunction, float budgetMicroseconds = 1000.f, float agingPerFrame = 0.1f);
+
+		void SetBudget(float microseconds) { m_BudgetMicroseconds = microseconds; }
+		float GetBudget() const { return m_BudgetMicroseconds; }
+		void SetAging(float priorityPerFrame) { m_AgingPerFrame = priorityPerFrame; }
+
+		// Higher priorities are served first, deadlineInFrames is the number of Update calls the path may take
+		// Views that offer CanReach (see EGraphViews.h) fail unreachable requests right away, those never get a search or
+		// show up in the frame stats
+		RequestId RequestPath(int startIdx, int goalIdx, int priority = 0, int deadlineInFrames = NoDeadline);
+		void CancelRequest(RequestId id) { m_Jobs.erase(id); }
+		RequestStatus GetStatus(RequestId id) const;
+		// Hands out a finished path (empty when it failed) and forgets the request, false while it is still pending
+		bool TakePath(RequestId id, std::vector<int>& path);
+
+		// Call once per frame, works at least one slice if anything is pending (so a slice can run over the budget)
+		void Update();
+
+		struct FrameStats
+		{
+			float usedMicroseconds = 0.f;
+			int nrOfPendingRequests = 0;
+			int nrOfCompletedRequests = 0; // this frame
+			int nrOfMissedDeadlines = 0; // since the start
+			float averageLatencyInFrames = 0.f; // from request to completion, since the start
+		};
+		const FrameStats& GetFrameStats() const { return m_FrameStats; }
+
+		// Nodes expanded between two budget checks
+		static constexpr int ExpansionsPerSlice = 64;
+
+	private:
+		using Search = AStarSearch<T_GraphView, float, HashedSearchRecords<float>>;
+
+		struct Job
+		{
+			RequestId id;
+			int startIdx;
+			int goalIdx;
+			int priority;
+			int requestFrame;
+			int deadlineFrame;
+			RequestStatus status = RequestStatus::Pending;
+
+			// Search state, only allocated once the job is started and released once it finishes
+			// Hashed on node index, so many jobs in flight on a big graph only hold the nodes they reached
+			std::unique_ptr<Search> pSearch;
+
+			std::vector<int> path;
+		};
+
+		bool IsMoreUrgent(const Job& job, const Job& other) const;
+		Job* SelectJob();
+		// Returns true once the job's search is done
+		bool Expand(Job& job, int maxExpansions) const;
+		void Finish(Job& job);
+
+		const T_GraphView* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		float m_BudgetMicroseconds;
+		float m_AgingPerFrame;
+
+		std::unordered_map<RequestId, Job> m_Jobs;
+		RequestId m_NextRequestId = 0;
+		int m_Frame = 0;
+
+		FrameStats m_FrameStats{};
+		long long m_NrOfCompletedRequests = 0;
+		long long m_TotalLatencyInFrames = 0;
+	};
+
+	template <class T_GraphView>
+	PathScheduler<T_GraphView>::PathScheduler(const T_GraphView* pGraph, Heuristic hFunction, float budgetMicroseconds, float agingPerFrame)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_BudgetMicroseconds(budgetMicroseconds)
+		, m_AgingPerFrame(agingPerFrame)
+	{
+		static_assert(IsGraphView_v<T_GraphView>, "<PathScheduler>: T_GraphView doesn't offer the graph view interface");
+	}
+
+	template <class T_GraphView>
+	typename PathScheduler<T_GraphView>::RequestId PathScheduler<T_GraphView>::RequestPath(int startIdx, int goalIdx, int priority, int deadlineInFrames)
+	{
+		assert(startIdx >= 0 && startIdx < m_pGraph->GetNrOfNodes() && goalIdx >= 0 && goalIdx < m_pGraph->GetNrOfNodes()
+			&& "<PathScheduler::RequestPath>: start or goal isn't a node of the graph");
+
+		Job job{};
+		job.id = m_NextRequestId++;
+		job.startIdx = startIdx;
+		job.goalIdx = goalIdx;
+		job.priority = priority;
+		job.requestFrame = m_Frame;
+		job.deadlineFrame = deadlineInFrames == NoDeadline ? NoDeadline : m_Frame + deadlineInFrames;
+
+		// Same check as AStar, a search for an unreachable goal would flood the start's whole component over several frames
+		if constexpr (HasCanReach_v<T_GraphView>)
+		{
+			if (!m_pGraph->CanReach(startIdx, goalIdx))
+				job.status = RequestStatus::Failed;
+		}
+
+		const RequestId id = job.id;
+		if (job.status == RequestStatus::Pending)
+			++m_FrameStats.nrOfPendingRequests;
+		m_Jobs.emplace(id, std::move(job));
+		return id;
+	}
+
+	template <class T_GraphView>
+	typename PathScheduler<T_GraphView>::RequestStatus PathScheduler<T_GraphView>::GetStatus(RequestId id) const
+	{
+		auto it = m_Jobs.find(id);
+		return it == m_Jobs.end() ? RequestStatus::Unknown : it->second.status;
+	}
+
+	template <class T_GraphView>
+	bool PathScheduler<T_GraphView>::TakePath(RequestId id, std::vector<int>& path)
+	{
+		auto it = m_Jobs.find(id);
+		if (it == m_Jobs.end() || it->second.status == RequestStatus::Pending)
+			return false;
+
+		path = std::move(it->second.path);
+		m_Jobs.erase(it);
+		return true;
+	}
+
+	template <class T_GraphView>
+	void PathScheduler<T_GraphView>::Update()
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		++m_Frame;
+		m_FrameStats.nrOfCompletedRequests = 0;
+
+		// Jobs are picked again after every slice, so a more urgent one can take over a half finished search
+		for (Job* pJob = SelectJob(); pJob != nullptr; pJob = SelectJob())
+		{
+			if (Expand(*pJob, ExpansionsPerSlice))
+				Finish(*pJob);
+
+			const float elapsedMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - startTime).count();
+			if (elapsedMicroseconds >= m_BudgetMicroseconds)
+				break;
+		}
+
+		m_FrameStats.usedMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - startTime).count();
+		m_FrameStats.nrOfPendingRequests = 0;
+		for (const auto& idJobPair : m_Jobs)
+		{
+			if (idJobPair.second.status == RequestStatus::Pending)
+				++m_FrameStats.nrOfPendingRequests;
+		}
+	}
+
+	template <class T_GraphView>
+	bool PathScheduler<T_GraphView>::IsMoreUrgent(const Job& job, const Job& other) const
+	{
+		const bool isDue = job.deadlineFrame <= m_Frame;
+		const bool isOtherDue = other.deadlineFrame <= m_Frame;
+		if (isDue != isOtherDue)
+			return isDue;
+
+		const float priority = job.priority + m_AgingPerFrame * (m_Frame - job.requestFrame);
+		const float otherPriority = other.priority + m_AgingPerFrame * (m_Frame - other.requestFrame);
+		if (priority != otherPriority)
+			return priority > otherPriority;
+
+		if (job.deadlineFrame != other.deadlineFrame)
+			return job.deadlineFrame < other.deadlineFrame;
+
+		return job.id < other.id;
+	}
+
+	template <class T_GraphView>
+	typename PathScheduler<T_GraphView>::Job* PathScheduler<T_GraphView>::SelectJob()
+	{
+		Job* pSelectedJob = nullptr;
+		for (auto& idJobPair : m_Jobs)
+		{
+			Job& job = idJobPair.second;
+			if (job.status == RequestStatus::Pending && (pSelectedJob == nullptr || IsMoreUrgent(job, *pSelectedJob)))
+				pSelectedJob = &job;
+		}
+		return pSelectedJob;
+	}
+
+	template <class T_GraphView>
+	bool PathScheduler<T_GraphView>::Expand(Job& job, int maxExpansions) const
+	{
+		if (!job.pSearch)
+		{
+			job.pSearch = std::make_unique<Search>(m_pGraph, m_HeuristicFunction);
+			job.pSearch->Start(job.startIdx, job.goalIdx);
+		}
+
+		const int goalIdx = job.goalIdx;
+		return job.pSearch->Expand(maxExpansions, [goalIdx](int idx) { return idx == goalIdx; });
+	}
+
+	template <class T_GraphView>
+	void PathScheduler<T_GraphView>::Finish(Job& job)
+	{
+		job.status = job.pSearch->GetFoundIdx() != invalid_node_index ? RequestStatus::Done : RequestStatus::Failed;
+		job.path = job.pSearch->GetPath();
+
+		// Release the search state, only the path is kept until it is taken
+		job.pSearch.reset();
+
+		++m_FrameStats.nrOfCompletedRequests;
+		if (m_Frame > job.deadlineFrame)
+			++m_FrameStats.nrOfMissedDeadlines;
+
+		++m_NrOfCompletedRequests;
+		m_TotalLatencyInFrames += m_Frame - job.requestFrame;
+		m_FrameStats.averageLatencyInFrames = float(m_TotalLatencyInFrames) / m_NrOfCompletedRequests;
+	}
+}
@@ -0,0 +1,421 @@
+#pragma once
+#include <assert.h>
+#include <limits>
+#include "EAStar.h"
+
+namespace Elite
+{
+	// Simple subgoal graph for diagonally connected grids
+	// Build places subgoals at the cells where shortest paths bend around obstacle corners and connects every pair
+	// of subgoals that can reach each other in a straight/diagonal line without passing another subgoal.
+	// A query links start and goal to the subgoals they see, searches the (much smaller) subgoal graph and
+	// fills in the cells between consecutive subgoals.
+	// Costs are the grid's default straight/diagonal costs, so only grids without Mud are supported (use WeightedJPS
+	// on maps with Mud). Connections removed or changed by hand are not seen, Build has to be redone after the terrain changes.
+	// FindPath only reads what Build stored, so several threads can query the same SubgoalGraph at once.
+	template <class T_NodeType, class T_ConnectionType>
+	class SubgoalGraph
+	{
+	public:
+		SubgoalGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
+
+		// Cells an agent of agentSize doesn't fit on (see GridGraph::GetClearance) are treated as obstacles
+		void Build(int agentSize = 1);
+		bool IsBuilt() const { return !m_IsFree.empty(); }
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) const;
+
+		// Grid indices of the subgoals, e.g. for debug rendering
+		const std::vector<int>& GetSubgoals() const { return m_Subgoals; }
+		int GetNrOfEdges() const { return int(m_EdgeTargets.size()); }
+
+	private:
+		// The subgoal graph with the start and goal of one query linked in, as a graph view for AStarSearch
+		// Node ids are subgoal ids, the start and goal get the two ids after them. Positions are (column, row).
+		class QueryView
+		{
+		public:
+			QueryView(const SubgoalGraph* pSubgoalGraph, int startIdx, int goalIdx, const std::vector<int>& startLinks, const std::vector<bool>& isLinkedToGoal)
+				: m_pSubgoalGraph(pSubgoalGraph), m_StartIdx(startIdx), m_GoalIdx(goalIdx), m_StartLinks(startLinks), m_IsLinkedToGoal(isLinkedToGoal) {}
+
+			int GetNrOfNodes() const { return GetStartId() + 2; }
+			int GetStartId() const { return int(m_pSubgoalGraph->m_Subgoals.size()); }
+			int GetGoalId() const { return GetStartId() + 1; }
+
+			int GetIdx(int id) const { return id == GetStartId() ? m_StartIdx : id == GetGoalId() ? m_GoalIdx : m_pSubgoalGraph->m_Subgoals[id]; }
+			Vector2 GetPosition(int id) const
+			{
+				int col, row;
+				m_pSubgoalGraph->m_pGraph->GetColRow(GetIdx(id), col, row);
+				return Vector2{ float(col), float(row) };
+			}
+
+			template <class T_Visit>
+			void ForEachNeighbor(int id, T_Visit&& visit) const
+			{
+				const int idx = GetIdx(id);
+				if (id == GetStartId())
+				{
+					for (int toIdx : m_StartLinks)
+						visit(toIdx == m_GoalIdx ? GetGoalId() : m_pSubgoalGraph->m_SubgoalIds[toIdx], m_pSubgoalGraph->GetOctileCost(idx, toIdx));
+					return;
+				}
+				if (id == GetGoalId())
+					return;
+
+				for (int e = m_pSubgoalGraph->m_EdgeOffsets[id]; e < m_pSubgoalGraph->m_EdgeOffsets[id + 1]; ++e)
+				{
+					const int toId = m_pSubgoalGraph->m_EdgeTargets[e];
+					visit(toId, m_pSubgoalGraph->GetOctileCost(idx, GetIdx(toId)));
+				}
+
+				if (m_IsLinkedToGoal[id])
+					visit(GetGoalId(), m_pSubgoalGraph->GetOctileCost(idx, m_GoalIdx));
+			}
+
+		private:
+			const SubgoalGraph* m_pSubgoalGraph;
+			int m_StartIdx;
+			int m_GoalIdx;
+			const std::vector<int>& m_StartLinks;
+			const std::vector<bool>& m_IsLinkedToGoal;
+		};
+
+		// Exact cost between cells linked in a straight/diagonal line, called on column and row differences
+		struct OctileHeuristic
+		{
+			float costStraight;
+			float costDiagonal;
+
+			float operator()(float dx, float dy) const { return std::min(dx, dy) * costDiagonal + abs(dx - dy) * costStraight; }
+		};
+
+		bool IsFree(int col, int row) const { return m_pGraph->IsWithinBounds(col, row) && m_IsFree[m_pGraph->GetIndex(col, row)]; }
+		bool IsSubgoal(int col, int row, int extraTargetIdx) const;
+		bool ShouldBeSubgoal(int col, int row) const;
+
+		// Number of free cells from (col, row) in direction (dx, dy) before an obstacle or a subgoal
+		int GetClearance(int col, int row, int dx, int dy, int extraTargetIdx) const;
+		// Subgoals (and extraTargetIdx) reachable from (col, row) in a straight/diagonal line without passing another subgoal
+		void GetDirectReachable(int col, int row, int extraTargetIdx, std::vector<int>& reachable) const;
+
+		float GetOctileCost(int fromIdx, int toIdx) const;
+		// Appends the cells after fromIdx up to and including toIdx, diagonal moves first
+		bool AddSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+
+		std::vector<bool> m_IsFree;
+		std::vector<int> m_ComponentLabels; // grid index -> free cells it reaches share a label, invalid_node_index for obstacles
+		std::vector<int> m_Subgoals; // subgoal id -> grid index
+		std::vector<int> m_SubgoalIds; // grid index -> subgoal id or invalid_node_index
+
+		// Edges of subgoal i are m_EdgeTargets[m_EdgeOffsets[i] .. m_EdgeOffsets[i + 1]]
+		std::vector<int> m_EdgeOffsets;
+		std::vector<int> m_EdgeTargets;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	SubgoalGraph<T_NodeType, T_ConnectionType>::SubgoalGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SubgoalGraph<T_NodeType, T_ConnectionType>::Build(int agentSize)
+	{
+		assert(m_pGraph->IsConnectedDiagonally() && "<SubgoalGraph::Build>: only diagonally connected grids are supported");
+
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		const int nrOfColumns = m_pGraph->GetColumns();
+		const int nrOfRows = m_pGraph->GetRows();
+
+		m_IsFree.assign(nrOfNodes, false);
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			m_IsFree[idx] = m_pGraph->CanFitAgent(idx, agentSize);
+			assert((!m_IsFree[idx] || m_pGraph->GetTerrainType(idx) != TerrainType::Mud) && "<SubgoalGraph::Build>: only grids with uniform costs (no Mud) are supported");
+		}
+
+		// 1. Components of the free cells, so queries between them don't need the graph's (lazily rebuilt) component cache
+		m_ComponentLabels.assign(nrOfNodes, invalid_node_index);
+		std::vector<int> openList{};
+		for (int seedIdx = 0; seedIdx < nrOfNodes; ++seedIdx)
+		{
+			if (!m_IsFree[seedIdx] || m_ComponentLabels[seedIdx] != invalid_node_index)
+				continue;
+
+			m_ComponentLabels[seedIdx] = seedIdx;
+			openList.assign(1, seedIdx);
+			while (!openList.empty())
+			{
+				int col, row;
+				m_pGraph->GetColRow(openList.back(), col, row);
+				openList.pop_back();
+
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						if (!IsFree(col + dx, row + dy))
+							continue;
+
+						int idx = m_pGraph->GetIndex(col + dx, row + dy);
+						if (m_ComponentLabels[idx] != invalid_node_index)
+							continue;
+
+						m_ComponentLabels[idx] = seedIdx;
+						openList.push_back(idx);
+					}
+				}
+			}
+		}
+
+		// 2. Subgoals
+		m_Subgoals.clear();
+		m_SubgoalIds.assign(nrOfNodes, invalid_node_index);
+		for (int r = 0; r < nrOfRows; ++r)
+		{
+			for (int c = 0; c < nrOfColumns; ++c)
+			{
+				if (!ShouldBeSubgoal(c, r))
+					continue;
+
+				int idx = m_pGraph->GetIndex(c, r);
+				m_SubgoalIds[idx] = int(m_Subgoals.size());
+				m_Subgoals.push_back(idx);
+			}
+		}
+
+		// 3. Edges between subgoals that directly reach each other
+		m_EdgeOffsets.assign(1, 0);
+		m_EdgeTargets.clear();
+
+		std::vector<int> reachable{};
+		for (int idx : m_Subgoals)
+		{
+			int col, row;
+			m_pGraph->GetColRow(idx, col, row);
+			GetDirectReachable(col, row, invalid_node_index, reachable);
+
+			for (int targetIdx : reachable)
+				m_EdgeTargets.push_back(m_SubgoalIds[targetIdx]);
+			m_EdgeOffsets.push_back(int(m_EdgeTargets.size()));
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> SubgoalGraph<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode) const
+	{
+		assert(IsBuilt() && "<SubgoalGraph::FindPath>: Build has to be called first");
+
+		std::vector<T_NodeType*> path{};
+
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		if (!m_IsFree[startIdx] || !m_IsFree[goalIdx] || m_ComponentLabels[startIdx] != m_ComponentLabels[goalIdx])
+			return path;
+
+		if (startIdx == goalIdx)
+		{
+			path.push_back(pStartNode);
+			return path;
+		}
+
+		// 1. Link start and goal, they get the ids after the subgoals
+		const int nrOfSubgoals = int(m_Subgoals.size());
+
+		int col, row;
+		std::vector<int> startLinks{};
+		m_pGraph->GetColRow(startIdx, col, row);
+		GetDirectReachable(col, row, goalIdx, startLinks);
+
+		// Reaching is symmetric, so the subgoals the goal reaches are the ones that reach the goal
+		std::vector<int> goalLinks{};
+		std::vector<bool> isLinkedToGoal(nrOfSubgoals, false);
+		m_pGraph->GetColRow(goalIdx, col, row);
+		GetDirectReachable(col, row, invalid_node_index, goalLinks);
+		for (int idx : goalLinks)
+			isLinkedToGoal[m_SubgoalIds[idx]] = true;
+
+		// 2. A* over the subgoals, the octile distance is exact between linked cells
+		const QueryView view{ this, startIdx, goalIdx, startLinks, isLinkedToGoal };
+		const OctileHeuristic octile{ m_pGraph->GetDefaultCostStraight(), m_pGraph->GetDefaultCostDiagonal() };
+		AStarSearch<QueryView, float, DenseSearchRecords<float>, OctileHeuristic> search{ &view, octile };
+
+		const int goalId = view.GetGoalId();
+		search.Start(view.GetStartId(), goalId);
+		search.Expand(std::numeric_limits<int>::max(), [goalId](int id) { return id == goalId; });
+		if (search.GetFoundIdx() == invalid_node_index)
+			return path;
+
+		// 3. Refine the subgoal path into cells
+		std::vector<int> subgoalPath = search.GetPath();
+		for (int& id : subgoalPath)
+			id = view.GetIdx(id);
+
+		path.push_back(pStartNode);
+		for (size_t i = 1; i < subgoalPath.size(); ++i)
+		{
+			if (!AddSegment(subgoalPath[i - 1], subgoalPath[i], path))
+				return {};
+		}
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool SubgoalGraph<T_NodeType, T_ConnectionType>::IsSubgoal(int col, int row, int extraTargetIdx) const
+	{
+		if (!m_pGraph->IsWithinBounds(col, row))
+			return false;
+
+		int idx = m_pGraph->GetIndex(col, row);
+		return m_SubgoalIds[idx] != invalid_node_index || idx == extraTargetIdx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool SubgoalGraph<T_NodeType, T_ConnectionType>::ShouldBeSubgoal(int col, int row) const
+	{
+		if (!IsFree(col, row))
+			return false;
+
+		// Diagonal moves may cut corners, so a shortest path only bends next to the end of a wall:
+		// an obstacle beside the cell with a free cell diagonally past it
+		const int straightDirections[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+		for (const auto& d : straightDirections)
+		{
+			int obstacleCol = col + d[0];
+			int obstacleRow = row + d[1];
+			if (!m_pGraph->IsWithinBounds(obstacleCol, obstacleRow) || IsFree(obstacleCol, obstacleRow))
+				continue;
+
+			if (IsFree(obstacleCol + d[1], obstacleRow + d[0]) || IsFree(obstacleCol - d[1], obstacleRow - d[0]))
+				return true;
+		}
+
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int SubgoalGraph<T_NodeType, T_ConnectionType>::GetClearance(int col, int row, int dx, int dy, int extraTargetIdx) const
+	{
+		int clearance = 0;
+		while (true)
+		{
+			col += dx;
+			row += dy;
+			if (!IsFree(col, row) || IsSubgoal(col, row, extraTargetIdx))
+				return clearance;
+
+			++clearance;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void SubgoalGraph<T_NodeType, T_ConnectionType>::GetDirectReachable(int col, int row, int extraTargetIdx, std::vector<int>& reachable) const
+	{
+		reachable.clear();
+
+		auto addIfSubgoal = [&](int c, int r)
+		{
+			if (IsFree(c, r) && IsSubgoal(c, r, extraTargetIdx))
+				reachable.push_back(m_pGraph->GetIndex(c, r));
+		};
+
+		// Straight lines stop at the first subgoal
+		const int straightDirections[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+		for (const auto& d : straightDirections)
+		{
+			int clearance = GetClearance(col, row, d[0], d[1], extraTargetIdx);
+			addIfSubgoal(col + (clearance + 1) * d[0], row + (clearance + 1) * d[1]);
+		}
+
+		// Each diagonal quadrant is scanned as diagonal steps followed by straight lines, a straight line can't
+		// go further than the one before it or it would pass behind the subgoal or obstacle that line stopped at
+		const int diagonalDirections[4][2] = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+		for (const auto& d : diagonalDirections)
+		{
+			int maxHorizontal = GetClearance(col, row, d[0], 0, extraTargetIdx);
+			int maxVertical = GetClearance(col, row, 0, d[1], extraTargetIdx);
+
+			int diagonalClearance = GetClearance(col, row, d[0], d[1], extraTargetIdx);
+			addIfSubgoal(col + (diagonalClearance + 1) * d[0], row + (diagonalClearance + 1) * d[1]);
+
+			for (int i = 1; i <= diagonalClearance; ++i)
+			{
+				int c = col + i * d[0];
+				int r = row + i * d[1];
+
+				int horizontal = GetClearance(c, r, d[0], 0, extraTargetIdx);
+				if (horizontal <= maxHorizontal)
+					addIfSubgoal(c + (horizontal + 1) * d[0], r);
+				maxHorizontal = std::min(maxHorizontal, horizontal);
+
+				int vertical = GetClearance(c, r, 0, d[1], extraTargetIdx);
+				if (vertical <= maxVertical)
+					addIfSubgoal(c, r + (vertical + 1) * d[1]);
+				maxVertical = std::min(maxVertical, vertical);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float SubgoalGraph<T_NodeType, T_ConnectionType>::GetOctileCost(int fromIdx, int toIdx) const
+	{
+		int fromCol, fromRow, toCol, toRow;
+		m_pGraph->GetColRow(fromIdx, fromCol, fromRow);
+		m_pGraph->GetColRow(toIdx, toCol, toRow);
+
+		int dx = abs(toCol - fromCol);
+		int dy = abs(toRow - fromRow);
+		return std::min(dx, dy) * m_pGraph->GetDefaultCostDiagonal() + abs(dx - dy) * m_pGraph->GetDefaultCostStraight();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool SubgoalGraph<T_NodeType, T_ConnectionType>::AddSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path) const
+	{
+		int fromCol, fromRow, toCol, toRow;
+		m_pGraph->GetColRow(fromIdx, fromCol, fromRow);
+		m_pGraph->GetColRow(toIdx, toCol, toRow);
+
+		const int dx = (toCol > fromCol) - (toCol < fromCol);
+		const int dy = (toRow > fromRow) - (toRow < fromRow);
+		const int nrOfDiagonalSteps = std::min(abs(toCol - fromCol), abs(toRow - fromRow));
+		const int nrOfSteps = std::max(abs(toCol - fromCol), abs(toRow - fromRow));
+
+		// Cells of the line that takes its diagonal steps first, seen from (col, row)
+		auto getLine = [&](int col, int row, int stepX, int stepY, std::vector<int>& line)
+		{
+			line.clear();
+			for (int i = 0; i < nrOfSteps; ++i)
+			{
+				bool isDiagonal = i < nrOfDiagonalSteps;
+				col += (isDiagonal || abs(toCol - fromCol) > abs(toRow - fromRow)) ? stepX : 0;
+				row += (isDiagonal || abs(toRow - fromRow) > abs(toCol - fromCol)) ? stepY : 0;
+				if (!IsFree(col, row))
+					return false;
+				line.push_back(m_pGraph->GetIndex(col, row));
+			}
+			return true;
+		};
+
+		// The link was found from one of both ends, so one of the two lines is free
+		std::vector<int> line{};
+		if (!getLine(fromCol, fromRow, dx, dy, line))
+		{
+			if (!getLine(toCol, toRow, -dx, -dy, line))
+				return false;
+
+			// Walked from the other end: drop the end cell, reverse and finish on toIdx
+			line.pop_back();
+			std::reverse(line.begin(), line.end());
+			line.push_back(toIdx);
+		}
+
+		for (int idx : line)
+			path.push_back(m_pGraph->GetNode(idx));
+		return true;
+	}
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <assert.h>
+#include <queue>
+#include <limits>
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EJumpPointPath.h"
+#include "EGoalBounding.h"
+
+namespace Elite
+{
+	// Jump point search for grids with more than one terrain cost (Ground/Mud)
+	// Jumps only run through cells of the same terrain as where they started. A cell next to another terrain,
+	// or a cell of another terrain, is always a jump point, so the pruning never skips a cheaper route into
+	// a different cost region. Inside uniform regions it prunes like regular JPS.
+	// The heuristic has to be admissible for the cheapest terrain (e.g. Chebyshev for the default costs).
+	template <class T_NodeType, class T_ConnectionType>
+	class WeightedJPS
+	{
+	public:
+		WeightedJPS(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+
+		// Cells an agent of agentSize doesn't fit on (see GridGraph::GetClearance) are treated as obstacles
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, int agentSize = 1);
+		// Same search, but the cells between the jump points are only produced when the path gets walked
+		JumpPointPath<T_NodeType, T_ConnectionType> FindJumpPointPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, int agentSize = 1);
+
+		// Jump directions the goal bounds rule out are skipped at every jump point, only for the agent size the bounds
+		// were built for (nullptr turns it off)
+		void SetGoalBounding(const GoalBounding<T_NodeType, T_ConnectionType>* pGoalBounding) { m_pGoalBounding = pGoalBounding; }
+
+	private:
+		struct OpenRecord
+		{
+			int idx;
+			float fCost;
+
+			bool operator>(const OpenRecord& other) const { return fCost > other.fCost; }
+		};
+
+		// Returns the jump point reached from (col, row) in direction (dx, dy) or invalid_node_index, cost is the cost to get there
+		int Jump(int col, int row, int dx, int dy, int goalIdx, float& cost) const;
+
+		bool IsOpen(int col, int row) const { return m_pGraph->IsWithinBounds(col, row) && m_pGraph->CanFitAgent(m_pGraph->GetIndex(col, row), m_AgentSize); }
+		bool HasForcedNeighbor(int col, int row, int dx, int dy) const;
+		bool BordersOtherTerrain(int col, int row, TerrainType terrain) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_AgentSize = 1;
+		const GoalBounding<T_NodeType, T_ConnectionType>* m_pGoalBounding = nullptr;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	WeightedJPS<T_NodeType, T_ConnectionType>::WeightedJPS(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> WeightedJPS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, int agentSize)
+	{
+		return FindJumpPointPath(pStartNode, pGoalNode, agentSize).ToNodes();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	JumpPointPath<T_NodeType, T_ConnectionType> WeightedJPS<T_NodeType, T_ConnectionType>::FindJumpPointPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, int agentSize)
+	{
+		std::vector<int> jumpPoints{};
+		m_AgentSize = agentSize;
+
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		if (!m_pGraph->AreConnected(startIdx, goalIdx)
+			|| !m_pGraph->CanFitAgent(startIdx, agentSize)
+			|| !m_pGraph->CanFitAgent(goalIdx, agentSize))
+			return JumpPointPath<T_NodeType, T_ConnectionType>(m_pGraph, jumpPoints);
+
+		// 1. Search over jump points, every jump point expands all of its directions
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		std::vector<float> gCosts(nrOfNodes, std::numeric_limits<float>::max());
+		std::vector<int> parents(nrOfNodes, invalid_node_index);
+		std::vector<bool> isClosed(nrOfNodes, false);
+		std::priority_queue<OpenRecord, std::vector<OpenRecord>, std::greater<OpenRecord>> openList{};
+
+		gCosts[startIdx] = 0.f;
+		openList.push({ startIdx, GetHeuristicCost(startIdx, goalIdx) });
+
+		const int nrOfDirections = m_pGraph->IsConnectedDiagonally() ? 8 : 4;
+		const int directions[8][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+		while (!openList.empty())
+		{
+			const int currentIdx = openList.top().idx;
+			openList.pop();
+
+			// Outdated entry, the node was reached cheaper before
+			if (isClosed[currentIdx])
+				continue;
+			isClosed[currentIdx] = true;
+
+			if (currentIdx == goalIdx)
+				break;
+
+			int col, row;
+			m_pGraph->GetColRow(currentIdx, col, row);
+			const bool usesGoalBounding = m_pGoalBounding != nullptr && m_pGoalBounding->GetAgentSize() == agentSize;
+			for (int d = 0; d < nrOfDirections; ++d)
+			{
+				// The first step of a jump is an edge like any other, no optimal path to the goal starts with a pruned one
+				if (usesGoalBounding && IsOpen(col + directions[d][0], row + directions[d][1])
+					&& !m_pGoalBounding->IsEdgeUseful(currentIdx, m_pGraph->GetIndex(col + directions[d][0], row + directions[d][1]), goalIdx))
+					continue;
+
+				float jumpCost = 0.f;
+				int jumpIdx = Jump(col, row, directions[d][0], directions[d][1], goalIdx, jumpCost);
+				if (jumpIdx == invalid_node_index || isClosed[jumpIdx])
+					continue;
+
+				float gCost = gCosts[currentIdx] + jumpCost;
+				if (gCost < gCosts[jumpIdx])
+				{
+					gCosts[jumpIdx] = gCost;
+					parents[jumpIdx] = currentIdx;
+					openList.push({ jumpIdx, gCost + GetHeuristicCost(jumpIdx, goalIdx) });
+				}
+			}
+		}
+
+		// 2. Walk back over the jump points, JumpPointPath fills in the straight or diagonal line of cells between each pair
+		if (isClosed[goalIdx])
+		{
+			for (int idx = goalIdx; idx != startIdx; idx = parents[idx])
+				jumpPoints.push_back(idx);
+			jumpPoints.push_back(startIdx);
+			std::reverse(jumpPoints.begin(), jumpPoints.end());
+		}
+
+		return JumpPointPath<T_NodeType, T_ConnectionType>(m_pGraph, std::move(jumpPoints));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int WeightedJPS<T_NodeType, T_ConnectionType>::Jump(int col, int row, int dx, int dy, int goalIdx, float& cost) const
+	{
+		const TerrainType regionTerrain = m_pGraph->GetTerrainType(m_pGraph->GetIndex(col, row));
+
+		while (true)
+		{
+			const int nextCol = col + dx;
+			const int nextRow = row + dy;
+			if (!IsOpen(nextCol, nextRow))
+				return invalid_node_index;
+
+			// Costs come from the actual connections, so removed or overridden connections are respected
+			const T_ConnectionType* pConnection = m_pGraph->GetConnection(m_pGraph->GetIndex(col, row), m_pGraph->GetIndex(nextCol, nextRow));
+			if (pConnection == nullptr)
+				return invalid_node_index;
+
+			cost += pConnection->GetCost();
+			col = nextCol;
+			row = nextRow;
+
+			const int idx = m_pGraph->GetIndex(col, row);
+			if (idx == goalIdx)
+				return idx;
+
+			// Without diagonals the pruning rules don't apply, every cell is a jump point
+			if (!m_pGraph->IsConnectedDiagonally())
+				return idx;
+
+			// Entered or passing along another cost region
+			if (m_pGraph->GetTerrainType(idx) != regionTerrain || BordersOtherTerrain(col, row, regionTerrain))
+				return idx;
+
+			if (HasForcedNeighbor(col, row, dx, dy))
+				return idx;
+
+			// Diagonal moves stop where one of their straight components finds a jump point
+			if (dx != 0 && dy != 0)
+			{
+				float straightCost = 0.f;
+				if (Jump(col, row, dx, 0, goalIdx, straightCost) != invalid_node_index
+					|| Jump(col, row, 0, dy, goalIdx, straightCost) != invalid_node_index)
+					return idx;
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool WeightedJPS<T_NodeType, T_ConnectionType>::HasForcedNeighbor(int col, int row, int dx, int dy) const
+	{
+		if (dx != 0 && dy != 0)
+		{
+			return (!IsOpen(col - dx, row) && IsOpen(col - dx, row + dy))
+				|| (!IsOpen(col, row - dy) && IsOpen(col + dx, row - dy));
+		}
+
+		if (dx != 0)
+		{
+			return (!IsOpen(col, row + 1) && IsOpen(col + dx, row + 1))
+				|| (!IsOpen(col, row - 1) && IsOpen(col + dx, row - 1));
+		}
+
+		return (!IsOpen(col + 1, row) && IsOpen(col + 1, row + dy))
+			|| (!IsOpen(col - 1, row) && IsOpen(col - 1, row + dy));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool WeightedJPS<T_NodeType, T_ConnectionType>::BordersOtherTerrain(int col, int row, TerrainType terrain) const
+	{
+		for (int r = row - 1; r <= row + 1; ++r)
+		{
+			for (int c = col - 1; c <= col + 1; ++c)
+			{
+				if (IsOpen(c, r) && m_pGraph->GetTerrainType(m_pGraph->GetIndex(c, r)) != terrain)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float WeightedJPS<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
@@ -46,7 +46,7 @@ bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>
 		{
 			std::vector<TerrainType> terrainTypeVec{ TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
 
-			pGraph->GetNode(idx)->SetTerrainType(terrainTypeVec[m_SelectedTerrainType]);
+			pGraph->SetTerrainType(idx, terrainTypeVec[m_SelectedTerrainType]);
 			
 			switch (terrainTypeVec[m_SelectedTerrainType])
 			{
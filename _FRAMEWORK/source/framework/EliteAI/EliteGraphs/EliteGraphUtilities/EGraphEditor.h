@@ -55,7 +55,10 @@ namespace Elite
 				if (clickedIdx != invalid_node_index && m_SelectedNodeIdx != clickedIdx)
 				{
 					if (pGraph->IsUniqueConnection(m_SelectedNodeIdx, clickedIdx))
+					{
 						pGraph->AddConnection(new T_ConnectionType(m_SelectedNodeIdx, clickedIdx));
+						hasGraphChanged = true;
+					}
 				}
 
 				m_SelectedNodeIdx = invalid_node_index;
@@ -67,6 +70,7 @@ namespace Elite
 			else
 			{
 				pGraph->AddNode(new T_NodeType(pGraph->GetNextFreeNodeIndex(), m_MousePos));
+				hasGraphChanged = true;
 			}
 		}
 
@@ -77,11 +81,17 @@ namespace Elite
 		{
 			auto clickedConnection = pGraph->GetConnectionAtPosition(m_MousePos);
 			if (clickedConnection)
+			{
 				pGraph->RemoveConnection(clickedConnection->GetFrom(), clickedConnection->GetTo());
+				hasGraphChanged = true;
+			}
 
 			int clickedIdx = pGraph->GetNodeIdxAtWorldPos(m_MousePos);
 			if (clickedIdx != invalid_node_index)
+			{
 				pGraph->RemoveNode(clickedIdx);
+				hasGraphChanged = true;
+			}
 		}
 
 		// Update pNode, edge and debug drawing positions
@@ -92,6 +102,7 @@ namespace Elite
 			{
 				DEBUGRENDERER2D->DrawCircle(nodePos, pGraph->GetNodeRadius(pGraph->GetNode(m_SelectedNodeIdx)), { 1,1,1 }, -1);
 				pGraph->GetNode(m_SelectedNodeIdx)->SetPosition(m_MousePos);
+				hasGraphChanged = true; // distance based costs change with it
 			}
 
 			if (!m_IsLeftMouseBtnPressed)
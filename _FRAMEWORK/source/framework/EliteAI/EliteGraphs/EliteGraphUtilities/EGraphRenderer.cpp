@@ -26,7 +26,22 @@ namespace Elite
 		DEBUGRENDERER2D->DrawString(pos + stringOffset, text.c_str());
 	}
 
-	
+	void GraphRenderer::RenderGraph(ChunkedGridGraph* pGraph, const Vector2& viewMin, const Vector2& viewMax) const
+	{
+		const float cellSize = float(pGraph->GetCellSize());
+		const int minCol = std::max(int(viewMin.x / cellSize), 0);
+		const int minRow = std::max(int(viewMin.y / cellSize), 0);
+		const int maxCol = std::min(int(viewMax.x / cellSize), pGraph->GetColumns() - 1);
+		const int maxRow = std::min(int(viewMax.y / cellSize), pGraph->GetRows() - 1);
+
+		for (int r = minRow; r <= maxRow; ++r)
+		{
+			for (int c = minCol; c <= maxCol; ++c)
+			{
+				RenderRectNode(pGraph->GetCellWorldPos(c, r), "", cellSize, GridTerrainNode::GetTerrainColor(pGraph->GetTerrainType(c, r)), 0.1f);
+			}
+		}
+	}
 
 	void GraphRenderer::RenderConnection(GraphConnection* con, Elite::Vector2 toPos, Elite::Vector2 fromPos, std::string text, Elite::Color col, float depth/*= 0.0f*/) const
 	{
@@ -5,6 +5,8 @@
 #include "framework\EliteAI\EliteGraphs\EGraphConnectionTypes.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
+#include "framework\EliteAI\EliteGraphs\EChunkedGridGraph.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EJumpPointPath.h"
 #include  <type_traits>
 
 namespace Elite 
@@ -21,8 +23,14 @@ namespace Elite
 		template<class T_NodeType, class T_ConnectionType>
 		void RenderGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph, bool renderNodes, bool renderNodeTxt, bool renderConnections, bool renderConnectionsCosts) const;
 
+		// Only the cells inside the view are drawn, tiles are fetched through the graph's cache
+		void RenderGraph(ChunkedGridGraph* pGraph, const Vector2& viewMin, const Vector2& viewMax) const;
+
 		template<class T_NodeType, class T_ConnectionType>
 		void HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*> path, Color col = HIGHLIGHTED_NODE_COLOR) const;
+		// Walks the cells between the jump points without expanding the path
+		template<class T_NodeType, class T_ConnectionType>
+		void HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, const JumpPointPath<T_NodeType, T_ConnectionType>& path, Color col = HIGHLIGHTED_NODE_COLOR) const;
 
 		void SetNumberPrintPrecision(int precision) { m_FloatPrintPrecision = precision; }
 
@@ -35,7 +43,12 @@ namespace Elite
 		template<class T_NodeType, typename = typename enable_if<! is_base_of<GraphNode2D, T_NodeType>::value>::type>
 		Elite::Color GetNodeColor(T_NodeType* pNode) const;
 		Elite::Color GetNodeColor(GraphNode2D* pNode) const;
-		Elite::Color GetNodeColor(GridTerrainNode* pNode) const;
+
+		// Terrain grids are colored straight from their terrain bytes, other grids ask their nodes
+		template<class T_NodeType, class T_ConnectionType>
+		Elite::Color GetCellColor(GridGraph<T_NodeType, T_ConnectionType>* pGraph, int idx) const;
+		template<class T_ConnectionType>
+		Elite::Color GetCellColor(GridGraph<GridTerrainNode, T_ConnectionType>* pGraph, int idx) const;
 
 		template<class T_ConnectionType>
 		Elite::Color GetConnectionColor(T_ConnectionType* pConnection) const;
@@ -65,7 +78,7 @@ namespace Elite
 		bool renderNodeTxt /*= true*/, 
 		bool renderConnectionTxt /*= true*/) const
 	{
-		for (auto node : pGraph->GetAllActiveNodes())
+		for (auto node : pGraph->GetActiveNodes())
 		{
 			if (renderNodes)
 			{
@@ -106,7 +119,7 @@ namespace Elite
 			{
 				for (auto c = 0; c < pGraph->m_NrOfColumns; ++c)
 				{
-					int idx = r * pGraph->m_NrOfColumns + c;
+					int idx = pGraph->GetIndex(c, r);
 					Vector2 cellPos{ pGraph->GetNodeWorldPos(idx) };
 					int cellSize = pGraph->m_CellSize;
 
@@ -115,14 +128,14 @@ namespace Elite
 					if (renderNodeNumbers)
 						nodeTxt = GetNodeText(pGraph->GetNode(idx));
 
-					RenderRectNode(cellPos, nodeTxt, float(cellSize), GetNodeColor(pGraph->GetNode(idx)), 0.1f);
+					RenderRectNode(cellPos, nodeTxt, float(cellSize), GetCellColor(pGraph, idx), 0.1f);
 				}
 			}
 		}
 
 		if (renderConnections)
 		{
-			for (auto node : pGraph->GetAllActiveNodes())
+			for (auto node : pGraph->GetActiveNodes())
 			{
 				//Connections
 				for (auto con : pGraph->GetNodeConnections(node->GetIndex()))
@@ -153,6 +166,13 @@ namespace Elite
 		}
 	}
 
+	template<class T_NodeType, class T_ConnectionType>
+	void GraphRenderer::HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, const JumpPointPath<T_NodeType, T_ConnectionType>& path, Color col /*= HIGHLIGHTED_NODE_COLOR*/) const
+	{
+		for (int idx : path)
+			RenderCircleNode(pGraph->GetNodeWorldPos(idx), "", 3.1f, col, -0.2f);
+	}
+
 	template<class T_NodeType, typename>
 	inline Elite::Color GraphRenderer::GetNodeColor(T_NodeType* pNode) const
 	{
@@ -164,9 +184,16 @@ namespace Elite
 		return pNode->GetColor();
 	}
 
-	inline Elite::Color GraphRenderer::GetNodeColor(GridTerrainNode* pNode) const
+	template<class T_NodeType, class T_ConnectionType>
+	inline Elite::Color GraphRenderer::GetCellColor(GridGraph<T_NodeType, T_ConnectionType>* pGraph, int idx) const
+	{
+		return GetNodeColor(pGraph->GetNode(idx));
+	}
+
+	template<class T_ConnectionType>
+	inline Elite::Color GraphRenderer::GetCellColor(GridGraph<GridTerrainNode, T_ConnectionType>* pGraph, int idx) const
 	{
-		return  pNode->GetColor();
+		return GridTerrainNode::GetTerrainColor(pGraph->GetTerrainType(idx));
 	}
 
 	template<class T_ConnectionType>
@@ -0,0 +1,244 @@
+#pragma once
+#include <assert.h>
+#include <memory>
+#include "framework\EliteHelpers\EEpochManager.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphViews.h"
+
+namespace Elite
+{
+	// Publishes immutable versions of a graph so worker threads can search while the main thread keeps editing
+	// The writer builds a new snapshot and publishes it, readers take the latest one through Read and can use it for as
+	// long as they hold the Reader. A replaced version is deleted once the last reader that could see it is gone
+	// (EpochManager), readers never lock or wait. T_Snapshot is any immutable graph view, e.g. GridSnapshot or
+	// CsrGraphView (for navmesh and waypoint graphs).
+	template <class T_Snapshot>
+	class VersionedGraph
+	{
+	public:
+		VersionedGraph() = default;
+		~VersionedGraph();
+
+		// Pinned access to one version
+		class Reader
+		{
+		public:
+			const T_Snapshot* Get() const { return m_pSnapshot; }
+			const T_Snapshot* operator->() const { return m_pSnapshot; }
+			const T_Snapshot& operator*() const { return *m_pSnapshot; }
+			explicit operator bool() const { return m_pSnapshot != nullptr; }
+			int GetVersion() const { return m_Version; }
+
+		private:
+			friend class VersionedGraph;
+			Reader(EpochManager::ReadGuard&& guard, const T_Snapshot* pSnapshot, int version) : m_Guard(std::move(guard)), m_pSnapshot(pSnapshot), m_Version(version) {}
+
+			EpochManager::ReadGuard m_Guard;
+			const T_Snapshot* m_pSnapshot;
+			int m_Version;
+		};
+
+		// Any thread, the snapshot is null before the first Publish
+		Reader Read() const;
+
+		// Writer thread only
+		void Publish(std::unique_ptr<const T_Snapshot> pSnapshot);
+		// Latest version without pinning, only safe on the writer thread (nothing else retires versions),
+		// e.g. to build the next GridSnapshot from
+		const T_Snapshot* GetLatest() const;
+		int GetLatestVersion() const;
+		int GetNrOfRetiredVersions() const { return m_Epochs.GetNrOfRetired(); }
+
+	private:
+		struct Version
+		{
+			std::unique_ptr<const T_Snapshot> pSnapshot;
+			int number;
+		};
+
+		mutable EpochManager m_Epochs;
+		std::atomic<Version*> m_pLatest{ nullptr };
+
+		VersionedGraph(const VersionedGraph&) = delete;
+		VersionedGraph& operator=(const VersionedGraph&) = delete;
+	};
+
+	// Immutable terrain grid split in square chunks, a snapshot built from the previous one shares every chunk that didn't change
+	// Indices are row-major (col + row * columns) whatever layout the source grid uses, costs follow the terrain the same
+	// way GridGraph generates them (hand edited connections aren't captured). It's a graph view for agents of one cell.
+	class GridSnapshot
+	{
+	public:
+		static constexpr int ChunkSize = 32;
+
+		// Copy-on-write: only the chunks the grid changed since pPrevious was taken from it are copied, the others are shared
+		// (GridGraph stamps every terrain chunk it changes, chunks keep their stamp here). O(changed chunks) copying.
+		template <class T_NodeType, class T_ConnectionType>
+		static std::unique_ptr<const GridSnapshot> FromGrid(const GridGraph<T_NodeType, T_ConnectionType>& grid, const GridSnapshot* pPrevious = nullptr);
+
+		int GetColumns() const { return m_NrOfColumns; }
+		int GetRows() const { return m_NrOfRows; }
+		bool IsWithinBounds(int col, int row) const { return col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows; }
+		int GetIndex(int col, int row) const { return col + row * m_NrOfColumns; }
+		void GetColRow(int idx, int& col, int& row) const { col = idx % m_NrOfColumns; row = idx / m_NrOfColumns; }
+
+		TerrainType GetTerrainType(int col, int row) const { return ByteToTerrainType(GetTerrainByte(col, row)); }
+		bool IsWalkable(int col, int row) const { return IsWithinBounds(col, row) && GetTerrainByte(col, row) != TerrainTypeToByte(TerrainType::Water); }
+
+		int GetNrOfChunks() const { return int(m_Chunks.size()); }
+		int GetNrOfSharedChunks(const GridSnapshot& other) const;
+
+		// Graph view interface (see EGraphViews.h)
+		int GetNrOfNodes() const { return m_NrOfColumns * m_NrOfRows; }
+		Vector2 GetPosition(int idx) const
+		{
+			int col, row;
+			GetColRow(idx, col, row);
+			return Vector2{ float(col), float(row) };
+		}
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const;
+
+	private:
+		using Chunk = std::vector<uint8_t>; // ChunkSize * ChunkSize terrain bytes, cells past the grid's edge are Water
+
+		uint8_t GetTerrainByte(int col, int row) const
+		{
+			return (*m_Chunks[(row / ChunkSize) * m_NrOfChunkColumns + col / ChunkSize])[(row % ChunkSize) * ChunkSize + col % ChunkSize];
+		}
+
+		static constexpr int NrOfDirections = 8;
+		static constexpr int Directions[NrOfDirections][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		int m_NrOfChunkColumns = 0;
+		bool m_IsConnectedDiagonally = true;
+		float m_CostStraight = 1.f;
+		float m_CostDiagonal = 1.5f;
+
+		std::vector<std::shared_ptr<const Chunk>> m_Chunks;
+		std::vector<uint64_t> m_ChunkStamps; // GridGraph::GetTerrainChunkStamp of each chunk when it was copied
+	};
+
+	template <class T_Snapshot>
+	VersionedGraph<T_Snapshot>::~VersionedGraph()
+	{
+		delete m_pLatest.load();
+	}
+
+	template <class T_Snapshot>
+	typename VersionedGraph<T_Snapshot>::Reader VersionedGraph<T_Snapshot>::Read() const
+	{
+		// Pin first, a version loaded after pinning can't be deleted before the guard is released
+		EpochManager::ReadGuard guard = m_Epochs.Pin();
+		const Version* pVersion = m_pLatest.load();
+		return Reader(std::move(guard), pVersion ? pVersion->pSnapshot.get() : nullptr, pVersion ? pVersion->number : 0);
+	}
+
+	template <class T_Snapshot>
+	void VersionedGraph<T_Snapshot>::Publish(std::unique_ptr<const T_Snapshot> pSnapshot)
+	{
+		Version* pVersion = new Version{ std::move(pSnapshot), GetLatestVersion() + 1 };
+		Version* pPrevious = m_pLatest.exchange(pVersion);
+		if (pPrevious)
+			m_Epochs.Retire([pPrevious]() { delete pPrevious; });
+	}
+
+	template <class T_Snapshot>
+	const T_Snapshot* VersionedGraph<T_Snapshot>::GetLatest() const
+	{
+		const Version* pVersion = m_pLatest.load();
+		return pVersion ? pVersion->pSnapshot.get() : nullptr;
+	}
+
+	template <class T_Snapshot>
+	int VersionedGraph<T_Snapshot>::GetLatestVersion() const
+	{
+		const Version* pVersion = m_pLatest.load();
+		return pVersion ? pVersion->number : 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::unique_ptr<const GridSnapshot> GridSnapshot::FromGrid(const GridGraph<T_NodeType, T_ConnectionType>& grid, const GridSnapshot* pPrevious)
+	{
+		auto pSnapshot = std::make_unique<GridSnapshot>();
+		pSnapshot->m_NrOfColumns = grid.GetColumns();
+		pSnapshot->m_NrOfRows = grid.GetRows();
+		pSnapshot->m_NrOfChunkColumns = (grid.GetColumns() + ChunkSize - 1) / ChunkSize;
+		pSnapshot->m_IsConnectedDiagonally = grid.IsConnectedDiagonally();
+		pSnapshot->m_CostStraight = grid.GetDefaultCostStraight();
+		pSnapshot->m_CostDiagonal = grid.GetDefaultCostDiagonal();
+
+		// Chunks can only be shared between snapshots of the same size
+		if (pPrevious && (pPrevious->m_NrOfColumns != pSnapshot->m_NrOfColumns || pPrevious->m_NrOfRows != pSnapshot->m_NrOfRows))
+			pPrevious = nullptr;
+
+		static_assert(ChunkSize == GridGraph<T_NodeType, T_ConnectionType>::TerrainChunkSize, "GridSnapshot::FromGrid: chunks have to match the grid's terrain chunks");
+		assert(grid.GetNrOfTerrainChunks() == pSnapshot->m_NrOfChunkColumns * ((grid.GetRows() + ChunkSize - 1) / ChunkSize) && "<GridSnapshot::FromGrid>: the grid's terrain chunks don't cover it");
+
+		const int nrOfChunks = grid.GetNrOfTerrainChunks();
+		const std::vector<uint8_t>& terrain = grid.GetTerrainData();
+		pSnapshot->m_Chunks.resize(nrOfChunks);
+		pSnapshot->m_ChunkStamps.resize(nrOfChunks);
+
+		for (int chunkIdx = 0; chunkIdx < nrOfChunks; ++chunkIdx)
+		{
+			const uint64_t stamp = grid.GetTerrainChunkStamp(chunkIdx);
+			pSnapshot->m_ChunkStamps[chunkIdx] = stamp;
+			if (pPrevious && pPrevious->m_ChunkStamps[chunkIdx] == stamp)
+			{
+				pSnapshot->m_Chunks[chunkIdx] = pPrevious->m_Chunks[chunkIdx];
+				continue;
+			}
+
+			const int firstCol = (chunkIdx % pSnapshot->m_NrOfChunkColumns) * ChunkSize;
+			const int firstRow = (chunkIdx / pSnapshot->m_NrOfChunkColumns) * ChunkSize;
+			auto pChunk = std::make_shared<Chunk>(ChunkSize * ChunkSize, TerrainTypeToByte(TerrainType::Water));
+			for (int r = 0; r < ChunkSize && firstRow + r < grid.GetRows(); ++r)
+			{
+				for (int c = 0; c < ChunkSize && firstCol + c < grid.GetColumns(); ++c)
+					(*pChunk)[r * ChunkSize + c] = terrain[grid.GetIndex(firstCol + c, firstRow + r)];
+			}
+			pSnapshot->m_Chunks[chunkIdx] = std::move(pChunk);
+		}
+
+		return pSnapshot;
+	}
+
+	inline int GridSnapshot::GetNrOfSharedChunks(const GridSnapshot& other) const
+	{
+		if (other.m_Chunks.size() != m_Chunks.size())
+			return 0;
+
+		int nrOfSharedChunks = 0;
+		for (size_t i = 0; i < m_Chunks.size(); ++i)
+		{
+			if (m_Chunks[i] == other.m_Chunks[i])
+				++nrOfSharedChunks;
+		}
+		return nrOfSharedChunks;
+	}
+
+	template <class T_Visit>
+	void GridSnapshot::ForEachNeighbor(int idx, T_Visit&& visit) const
+	{
+		int col, row;
+		GetColRow(idx, col, row);
+		const int fromFactor = int(ByteToTerrainType(GetTerrainByte(col, row)));
+
+		const int nrOfDirections = m_IsConnectedDiagonally ? NrOfDirections : 4;
+		for (int d = 0; d < nrOfDirections; ++d)
+		{
+			const int toCol = col + Directions[d][0];
+			const int toRow = row + Directions[d][1];
+			if (!IsWithinBounds(toCol, toRow))
+				continue;
+
+			// Same formula and cut-off as GridGraph::CalculateConnectionCost
+			const int toFactor = int(ByteToTerrainType(GetTerrainByte(toCol, toRow)));
+			const float cost = (d < 4 ? m_CostStraight : m_CostDiagonal) * (fromFactor + toFactor) / 2.f;
+			if (cost < 100000)
+				visit(GetIndex(toCol, toRow), cost);
+		}
+	}
+}
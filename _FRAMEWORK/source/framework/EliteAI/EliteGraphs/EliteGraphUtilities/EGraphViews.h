@@ -0,0 +1,237 @@
+#pragma once
+#include <assert.h>
+#include <type_traits>
+#include <utility>
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+
+namespace Elite
+{
+	// Graph views: the static interface the view-based searches (FindPathBFS, AStar and everything on AStarSearch) are written against
+	// A view offers
+	//   int GetNrOfNodes() const
+	//   template <class T_Visit> void ForEachNeighbor(int idx, T_Visit&& visit) const, calls visit(int toIdx, float cost)
+	//   Vector2 GetPosition(int idx) const, the position heuristics are computed on
+	// and optionally
+	//   bool CanReach(int fromIdx, int toIdx) const, a cheap test that lets a search give up on an unreachable goal right away
+	// The searches are instantiated per view type, so the accessors inline instead of going through IGraph's virtuals.
+	// IsGraphView checks a type against this interface at compile time (the project builds as C++17, so no concepts).
+	template <class T, class = void>
+	struct IsGraphView : std::false_type {};
+
+	template <class T>
+	struct IsGraphView<T, std::void_t<
+		decltype(int(std::declval<const T&>().GetNrOfNodes())),
+		decltype(Vector2(std::declval<const T&>().GetPosition(0))),
+		decltype(std::declval<const T&>().ForEachNeighbor(0, std::declval<void(*)(int, float)>()))>>
+		: std::true_type {};
+
+	template <class T>
+	constexpr bool IsGraphView_v = IsGraphView<T>::value;
+
+	template <class T, class = void>
+	struct HasCanReach : std::false_type {};
+
+	template <class T>
+	struct HasCanReach<T, std::void_t<decltype(bool(std::declval<const T&>().CanReach(0, 0)))>> : std::true_type {};
+
+	template <class T>
+	constexpr bool HasCanReach_v = HasCanReach<T>::value;
+
+	// Any IGraph through its connection lists, positions still go through the virtual GetNodePos
+	// This is how code written against IGraph uses the view-based searches, e.g. AStar<IGraphView<T_NodeType, T_ConnectionType>>
+	template <class T_NodeType, class T_ConnectionType>
+	class IGraphView
+	{
+	public:
+		IGraphView(const IGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize = 1) : m_pGraph(pGraph), m_AgentSize(agentSize) {}
+
+		int GetNrOfNodes() const { return m_pGraph->GetNrOfNodes(); }
+		Vector2 GetPosition(int idx) const { return m_pGraph->GetNodePos(idx); }
+		bool CanReach(int fromIdx, int toIdx) const
+		{
+			return m_pGraph->AreConnected(fromIdx, toIdx) && m_pGraph->CanFitAgent(fromIdx, m_AgentSize) && m_pGraph->CanFitAgent(toIdx, m_AgentSize);
+		}
+
+		const IGraph<T_NodeType, T_ConnectionType>* GetGraph() const { return m_pGraph; }
+		int GetAgentSize() const { return m_AgentSize; }
+
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const
+		{
+			for (const auto& pConnection : m_pGraph->GetNodeConnections(idx))
+			{
+				if (m_AgentSize == 1 || m_pGraph->CanFitAgent(pConnection->GetTo(), m_AgentSize))
+					visit(pConnection->GetTo(), pConnection->GetCost());
+			}
+		}
+
+	private:
+		const IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		int m_AgentSize;
+	};
+
+	// GridGraph's connection lists, with positions and clearance read without virtual calls
+	template <class T_NodeType, class T_ConnectionType>
+	class GridGraphView
+	{
+	public:
+		GridGraphView(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize = 1) : m_pGraph(pGraph), m_AgentSize(agentSize) {}
+
+		int GetNrOfNodes() const { return m_pGraph->GetNrOfNodes(); }
+		Vector2 GetPosition(int idx) const
+		{
+			int col, row;
+			m_pGraph->GetColRow(idx, col, row);
+			return Vector2{ float(col), float(row) };
+		}
+		bool CanReach(int fromIdx, int toIdx) const
+		{
+			using Grid = GridGraph<T_NodeType, T_ConnectionType>;
+			return m_pGraph->AreConnected(fromIdx, toIdx) && m_pGraph->Grid::CanFitAgent(fromIdx, m_AgentSize) && m_pGraph->Grid::CanFitAgent(toIdx, m_AgentSize);
+		}
+
+		const GridGraph<T_NodeType, T_ConnectionType>* GetGraph() const { return m_pGraph; }
+		int GetAgentSize() const { return m_AgentSize; }
+
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const
+		{
+			for (const auto& pConnection : m_pGraph->GetConnections(idx))
+			{
+				if (m_pGraph->GridGraph<T_NodeType, T_ConnectionType>::CanFitAgent(pConnection->GetTo(), m_AgentSize))
+					visit(pConnection->GetTo(), pConnection->GetCost());
+			}
+		}
+
+	private:
+		const GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		int m_AgentSize;
+	};
+
+	// Grid neighbors computed from the terrain instead of stored, no node or connection objects are touched
+	// Follows the costs GridGraph generates (connections edited by hand aren't seen), indices match the grid's layout
+	// Reads the grid's terrain and clearance on every expansion, so it is free to create and sees terrain edits right away
+	template <class T_NodeType, class T_ConnectionType>
+	class ImplicitGridView
+	{
+	public:
+		ImplicitGridView(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize = 1);
+
+		int GetNrOfNodes() const { return m_pGraph->GetColumns() * m_pGraph->GetRows(); }
+		Vector2 GetPosition(int idx) const
+		{
+			int col, row;
+			m_pGraph->GetColRow(idx, col, row);
+			return Vector2{ float(col), float(row) };
+		}
+
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const;
+
+	private:
+		static constexpr int NrOfDirections = 8;
+		const int m_Directions[NrOfDirections][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+		const GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		int m_AgentSize;
+		int m_NrOfDirections;
+		float m_CostStraight;
+		float m_CostDiagonal;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	ImplicitGridView<T_NodeType, T_ConnectionType>::ImplicitGridView(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize)
+		: m_pGraph(pGraph)
+		, m_AgentSize(agentSize)
+		, m_NrOfDirections(pGraph->IsConnectedDiagonally() ? 8 : 4)
+		, m_CostStraight(pGraph->GetDefaultCostStraight())
+		, m_CostDiagonal(pGraph->GetDefaultCostDiagonal())
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <class T_Visit>
+	void ImplicitGridView<T_NodeType, T_ConnectionType>::ForEachNeighbor(int idx, T_Visit&& visit) const
+	{
+		using Grid = GridGraph<T_NodeType, T_ConnectionType>;
+		const std::vector<uint8_t>& terrain = m_pGraph->GetTerrainData();
+
+		int col, row;
+		m_pGraph->GetColRow(idx, col, row);
+		const float fromFactor = float(int(ByteToTerrainType(terrain[idx])));
+
+		for (int d = 0; d < m_NrOfDirections; ++d)
+		{
+			const int toCol = col + m_Directions[d][0];
+			const int toRow = row + m_Directions[d][1];
+			if (!m_pGraph->IsWithinBounds(toCol, toRow))
+				continue;
+
+			// The clearance is 0 on Water, so this also skips cells nobody can walk on
+			const int toIdx = m_pGraph->GetIndex(toCol, toRow);
+			if (!m_pGraph->Grid::CanFitAgent(toIdx, m_AgentSize))
+				continue;
+
+			// Same formula and cut-off as GridGraph::CalculateConnectionCost, the terrain type is the cost factor
+			const float cost = (d < 4 ? m_CostStraight : m_CostDiagonal) * (fromFactor + float(int(ByteToTerrainType(terrain[toIdx])))) / 2.f;
+			if (cost < 100000)
+				visit(toIdx, cost);
+		}
+	}
+
+	// Immutable snapshot of any graph in compressed sparse row form: flat arrays, no pointers to chase
+	// Has to be rebuilt after the graph changes
+	class CsrGraphView
+	{
+	public:
+		CsrGraphView() = default;
+
+		template <class T_NodeType, class T_ConnectionType>
+		static CsrGraphView FromGraph(const IGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize = 1);
+
+		int GetNrOfNodes() const { return int(m_Positions.size()); }
+		Vector2 GetPosition(int idx) const { return m_Positions[idx]; }
+
+		template <class T_Visit>
+		void ForEachNeighbor(int idx, T_Visit&& visit) const
+		{
+			for (int e = m_Offsets[idx]; e < m_Offsets[idx + 1]; ++e)
+				visit(m_Targets[e], m_Costs[e]);
+		}
+
+	private:
+		// Connections of node i are m_Targets/m_Costs[m_Offsets[i] .. m_Offsets[i + 1]]
+		std::vector<int> m_Offsets;
+		std::vector<int> m_Targets;
+		std::vector<float> m_Costs;
+		std::vector<Vector2> m_Positions;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	CsrGraphView CsrGraphView::FromGraph(const IGraph<T_NodeType, T_ConnectionType>* pGraph, int agentSize)
+	{
+		CsrGraphView view{};
+		const int nrOfNodes = pGraph->GetNrOfNodes();
+
+		view.m_Offsets.assign(1, 0);
+		view.m_Positions.resize(nrOfNodes);
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			if (pGraph->IsNodeValid(idx))
+			{
+				view.m_Positions[idx] = pGraph->GetNodePos(idx);
+				for (const auto& pConnection : pGraph->GetNodeConnections(idx))
+				{
+					if (!pGraph->CanFitAgent(pConnection->GetTo(), agentSize))
+						continue;
+
+					view.m_Targets.push_back(pConnection->GetTo());
+					view.m_Costs.push_back(pConnection->GetCost());
+				}
+			}
+			view.m_Offsets.push_back(int(view.m_Targets.size()));
+		}
+
+		return view;
+	}
+}
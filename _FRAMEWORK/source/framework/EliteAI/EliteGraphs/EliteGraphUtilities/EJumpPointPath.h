@@ -0,0 +1,208 @@
+#pragma once
+#include <assert.h>
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+
+namespace Elite
+{
+	// Grid path that only stores its jump points, consecutive jump points lie on one straight or diagonal line
+	// The cells in between are produced on demand by CellIterator, steering consumers can aim for the next jump point
+	// instead. A replan mid-route keeps the part that was already walked (Truncate) and appends the new route (Splice).
+	template <class T_NodeType, class T_ConnectionType>
+	class JumpPointPath
+	{
+	public:
+		JumpPointPath() = default;
+		JumpPointPath(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<int> jumpPoints);
+		// Keeps the cells where the direction changes, e.g. to compress a cell by cell JPS or A* path
+		static JumpPointPath FromCells(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, const std::vector<T_NodeType*>& cells);
+
+		// Walks the cells from the first jump point to the last, both included
+		class CellIterator
+		{
+		public:
+			int operator*() const;
+			CellIterator& operator++();
+			bool operator==(const CellIterator& other) const { return m_Segment == other.m_Segment && m_Step == other.m_Step; }
+			bool operator!=(const CellIterator& other) const { return !(*this == other); }
+
+			// Index of the jump point the current cell comes after (or is on)
+			int GetSegment() const { return m_Segment; }
+
+		private:
+			friend class JumpPointPath;
+			CellIterator(const JumpPointPath* pPath, int segment, int step) : m_pPath(pPath), m_Segment(segment), m_Step(step) {}
+
+			const JumpPointPath* m_pPath;
+			int m_Segment;
+			int m_Step; // cells walked from the segment's jump point
+		};
+
+		CellIterator begin() const { return CellIterator(this, 0, 0); }
+		CellIterator end() const { return CellIterator(this, GetNrOfJumpPoints(), 0); }
+
+		bool IsEmpty() const { return m_JumpPoints.empty(); }
+		int GetNrOfJumpPoints() const { return int(m_JumpPoints.size()); }
+		const std::vector<int>& GetJumpPoints() const { return m_JumpPoints; }
+		int GetNrOfCells() const;
+
+		// Straight line steering target for an agent on the iterator's cell: the next jump point
+		Vector2 GetSteeringTarget(const CellIterator& it) const;
+
+		// Eager expansion, for consumers that want the whole cell path (e.g. GraphRenderer::HighlightNodes)
+		std::vector<T_NodeType*> ToNodes() const;
+
+		// Drops everything after the iterator's cell, that cell becomes the last jump point
+		void Truncate(const CellIterator& it);
+		// Truncates at the iterator's cell and appends tail, which has to start on that cell
+		void Splice(const CellIterator& it, const JumpPointPath& tail);
+
+	private:
+		// Cells between jump point segment and the next one
+		int GetSegmentLength(int segment) const;
+		int GetCell(int segment, int step) const;
+
+		const GridGraph<T_NodeType, T_ConnectionType>* m_pGraph = nullptr;
+		std::vector<int> m_JumpPoints;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	JumpPointPath<T_NodeType, T_ConnectionType>::JumpPointPath(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<int> jumpPoints)
+		: m_pGraph(pGraph)
+		, m_JumpPoints(std::move(jumpPoints))
+	{
+		for (int segment = 0; segment + 1 < GetNrOfJumpPoints(); ++segment)
+		{
+			int col, row, nextCol, nextRow;
+			m_pGraph->GetColRow(m_JumpPoints[segment], col, row);
+			m_pGraph->GetColRow(m_JumpPoints[segment + 1], nextCol, nextRow);
+			const int dx = abs(nextCol - col);
+			const int dy = abs(nextRow - row);
+			assert((dx == 0 || dy == 0 || dx == dy) && dx + dy > 0 && "<JumpPointPath::JumpPointPath>: consecutive jump points have to differ and lie on a straight or diagonal line");
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	JumpPointPath<T_NodeType, T_ConnectionType> JumpPointPath<T_NodeType, T_ConnectionType>::FromCells(const GridGraph<T_NodeType, T_ConnectionType>* pGraph, const std::vector<T_NodeType*>& cells)
+	{
+		std::vector<int> jumpPoints{};
+		for (size_t i = 0; i < cells.size(); ++i)
+		{
+			if (i == 0 || i + 1 == cells.size())
+			{
+				jumpPoints.push_back(cells[i]->GetIndex());
+				continue;
+			}
+
+			int prevCol, prevRow, col, row, nextCol, nextRow;
+			pGraph->GetColRow(cells[i - 1]->GetIndex(), prevCol, prevRow);
+			pGraph->GetColRow(cells[i]->GetIndex(), col, row);
+			pGraph->GetColRow(cells[i + 1]->GetIndex(), nextCol, nextRow);
+
+			if (nextCol - col != col - prevCol || nextRow - row != row - prevRow)
+				jumpPoints.push_back(cells[i]->GetIndex());
+		}
+
+		return JumpPointPath(pGraph, std::move(jumpPoints));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointPath<T_NodeType, T_ConnectionType>::CellIterator::operator*() const
+	{
+		return m_pPath->GetCell(m_Segment, m_Step);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename JumpPointPath<T_NodeType, T_ConnectionType>::CellIterator& JumpPointPath<T_NodeType, T_ConnectionType>::CellIterator::operator++()
+	{
+		// The last jump point has no segment after it
+		if (m_Segment + 1 >= m_pPath->GetNrOfJumpPoints())
+		{
+			m_Segment = m_pPath->GetNrOfJumpPoints();
+			m_Step = 0;
+			return *this;
+		}
+
+		if (++m_Step == m_pPath->GetSegmentLength(m_Segment))
+		{
+			++m_Segment;
+			m_Step = 0;
+		}
+		return *this;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointPath<T_NodeType, T_ConnectionType>::GetNrOfCells() const
+	{
+		if (IsEmpty())
+			return 0;
+
+		int nrOfCells = 1;
+		for (int segment = 0; segment + 1 < GetNrOfJumpPoints(); ++segment)
+			nrOfCells += GetSegmentLength(segment);
+		return nrOfCells;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	Vector2 JumpPointPath<T_NodeType, T_ConnectionType>::GetSteeringTarget(const CellIterator& it) const
+	{
+		assert(!IsEmpty() && "<JumpPointPath::GetSteeringTarget>: path is empty");
+
+		const int targetIdx = std::min(it.GetSegment() + 1, GetNrOfJumpPoints() - 1);
+		return m_pGraph->GetNodeWorldPos(m_JumpPoints[targetIdx]);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JumpPointPath<T_NodeType, T_ConnectionType>::ToNodes() const
+	{
+		std::vector<T_NodeType*> nodes{};
+		nodes.reserve(GetNrOfCells());
+		for (int idx : *this)
+			nodes.push_back(m_pGraph->GetNode(idx));
+		return nodes;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointPath<T_NodeType, T_ConnectionType>::Truncate(const CellIterator& it)
+	{
+		assert(it != end() && "<JumpPointPath::Truncate>: iterator has to point to a cell of the path");
+
+		const int cellIdx = *it;
+		m_JumpPoints.resize(it.GetSegment() + 1);
+		if (m_JumpPoints.back() != cellIdx)
+			m_JumpPoints.push_back(cellIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointPath<T_NodeType, T_ConnectionType>::Splice(const CellIterator& it, const JumpPointPath& tail)
+	{
+		Truncate(it);
+		if (tail.IsEmpty())
+			return;
+
+		assert(tail.m_JumpPoints.front() == m_JumpPoints.back() && "<JumpPointPath::Splice>: tail has to start on the iterator's cell");
+		m_JumpPoints.insert(m_JumpPoints.end(), tail.m_JumpPoints.begin() + 1, tail.m_JumpPoints.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointPath<T_NodeType, T_ConnectionType>::GetSegmentLength(int segment) const
+	{
+		int col, row, nextCol, nextRow;
+		m_pGraph->GetColRow(m_JumpPoints[segment], col, row);
+		m_pGraph->GetColRow(m_JumpPoints[segment + 1], nextCol, nextRow);
+		return std::max(abs(nextCol - col), abs(nextRow - row));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointPath<T_NodeType, T_ConnectionType>::GetCell(int segment, int step) const
+	{
+		if (step == 0)
+			return m_JumpPoints[segment];
+
+		int col, row, nextCol, nextRow;
+		m_pGraph->GetColRow(m_JumpPoints[segment], col, row);
+		m_pGraph->GetColRow(m_JumpPoints[segment + 1], nextCol, nextRow);
+		const int dx = (nextCol > col) - (nextCol < col);
+		const int dy = (nextRow > row) - (nextRow < row);
+		return m_pGraph->GetIndex(col + step * dx, row + step * dy);
+	}
+}
@@ -89,7 +89,8 @@ namespace Elite
 
 			//Run A star on new graph
 			Elite::Heuristic heuristicFunction = Elite::HeuristicFunctions::Euclidean;
-			auto pathfinder = AStar<NavGraphNode, GraphConnection2D>(pGraphCopy.get(), heuristicFunction);
+			const IGraphView<NavGraphNode, GraphConnection2D> graphView{ pGraphCopy.get() };
+			auto pathfinder = AStar<IGraphView<NavGraphNode, GraphConnection2D>>(&graphView, heuristicFunction);
 			auto path = pathfinder.FindPath(startNode, endNode);
 
 			for (auto node : path)
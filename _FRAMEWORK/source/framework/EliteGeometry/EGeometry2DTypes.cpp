@@ -341,6 +341,18 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 	return m_vpTriangles;
 }
 
+void Elite::Polygon::SetTriangulation(const std::vector<Triangle*>& triangles, const std::vector<Line*>& lines)
+{
+	for (auto t : m_vpTriangles)
+		SAFE_DELETE(t);
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+
+	m_vpTriangles = triangles;
+	m_vpLines = lines;
+	m_isTriangulated = true;
+}
+
 void Elite::Polygon::OrientateWithChildren(Winding winding)
 {
 	//Based on the orientation given rewind these points if necessary, change winding of children
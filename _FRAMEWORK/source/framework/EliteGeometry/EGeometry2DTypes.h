@@ -125,6 +125,8 @@ namespace Elite
 
 		//Triangulation functions
 		const std::vector<Triangle*>& Triangulate();
+		//Restore a triangulation that was computed before (f.e. a baked navmesh), the polygon takes ownership of the triangles and lines
+		void SetTriangulation(const std::vector<Triangle*>& triangles, const std::vector<Line*>& lines);
 		void OrientateWithChildren(Winding winding);
 		void ExpandShape(float amount);
 
@@ -0,0 +1,145 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EEpochManager.h: Epoch based reclamation, objects a writer replaced are only deleted once no reader that could
+// still see them is left
+/*=============================================================================*/
+#ifndef ELITE_EPOCH_MANAGER
+#define	ELITE_EPOCH_MANAGER
+
+#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Elite
+{
+	// Readers pin the current epoch for as long as they use shared objects, a writer that unpublishes an object retires it
+	// in the current epoch and moves the epoch on. The object is deleted once every pinned reader is in a later epoch.
+	// Pinning is one compare-exchange on a free reader slot, readers never wait on writers.
+	class EpochManager final
+	{
+	public:
+		static constexpr int MaxReaders = 64;
+
+		// Keeps the epoch pinned until destroyed, move only
+		class ReadGuard final
+		{
+		public:
+			ReadGuard(ReadGuard&& other) noexcept : m_pManager(other.m_pManager), m_Slot(other.m_Slot) { other.m_pManager = nullptr; }
+			ReadGuard& operator=(ReadGuard&&) = delete;
+			ReadGuard(const ReadGuard&) = delete;
+			ReadGuard& operator=(const ReadGuard&) = delete;
+			~ReadGuard() { if (m_pManager) m_pManager->Unpin(m_Slot); }
+
+		private:
+			friend class EpochManager;
+			ReadGuard(EpochManager* pManager, int slot) : m_pManager(pManager), m_Slot(slot) {}
+
+			EpochManager* m_pManager;
+			int m_Slot;
+		};
+
+		//=== Constructors & Destructors ===
+		EpochManager()
+		{
+			for (auto& readerEpoch : m_ReaderEpochs)
+				readerEpoch.store(0);
+		}
+		~EpochManager()
+		{
+			for (const auto& readerEpoch : m_ReaderEpochs)
+				assert(readerEpoch.load() == 0 && "<EpochManager::~EpochManager>: readers are still pinned");
+			for (auto& retired : m_Retired)
+				retired.deleter();
+		}
+
+		EpochManager(const EpochManager&) = delete;
+		EpochManager& operator=(const EpochManager&) = delete;
+
+		//=== Functions ===
+		// Waits (yielding) if all MaxReaders slots are taken
+		ReadGuard Pin()
+		{
+			while (true)
+			{
+				for (int slot = 0; slot < MaxReaders; ++slot)
+				{
+					uint64_t expected = 0;
+					if (m_ReaderEpochs[slot].compare_exchange_strong(expected, m_Epoch.load()))
+						return ReadGuard(this, slot);
+				}
+				std::this_thread::yield();
+			}
+		}
+
+		// Writer side: deleter runs once no reader pinned before this call is left
+		void Retire(std::function<void()> deleter)
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_RetiredMutex };
+				m_Retired.push_back({ m_Epoch.fetch_add(1), std::move(deleter) });
+				++m_NrOfRetired;
+			}
+			Reclaim();
+		}
+
+		// Runs the deleters that are safe now, also done by Retire and by the last reader of an epoch leaving
+		void Reclaim()
+		{
+			std::vector<std::function<void()>> deleters{};
+			{
+				std::lock_guard<std::mutex> lock{ m_RetiredMutex };
+
+				uint64_t oldestPinnedEpoch = std::numeric_limits<uint64_t>::max();
+				for (const auto& readerEpoch : m_ReaderEpochs)
+				{
+					const uint64_t epoch = readerEpoch.load();
+					if (epoch != 0)
+						oldestPinnedEpoch = std::min(oldestPinnedEpoch, epoch);
+				}
+
+				auto isSafe = [oldestPinnedEpoch](const Retired& retired) { return retired.epoch < oldestPinnedEpoch; };
+				for (auto& retired : m_Retired)
+				{
+					if (isSafe(retired))
+						deleters.push_back(std::move(retired.deleter));
+				}
+				m_Retired.erase(std::remove_if(m_Retired.begin(), m_Retired.end(), isSafe), m_Retired.end());
+				m_NrOfRetired = int(m_Retired.size());
+			}
+
+			// Outside the lock, deleters may be slow
+			for (auto& deleter : deleters)
+				deleter();
+		}
+
+		int GetNrOfRetired() const { return m_NrOfRetired; }
+
+	private:
+		struct Retired
+		{
+			uint64_t epoch;
+			std::function<void()> deleter;
+		};
+
+		void Unpin(int slot)
+		{
+			m_ReaderEpochs[slot].store(0);
+			if (m_NrOfRetired > 0)
+				Reclaim();
+		}
+
+		std::atomic<uint64_t> m_Epoch{ 1 }; // 0 marks a free reader slot
+		std::atomic<uint64_t> m_ReaderEpochs[MaxReaders];
+
+		std::mutex m_RetiredMutex;
+		std::vector<Retired> m_Retired;
+		std::atomic<int> m_NrOfRetired{ 0 };
+	};
+}
+#endif
@@ -0,0 +1,79 @@
+#include "stdafx.h"
+#include "EMemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool Elite::MemoryMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return false;
+
+	// The view keeps the mapping alive, so both handles can be released right away
+	void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (pView == nullptr)
+		return false;
+
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileStats {};
+	if (fstat(file, &fileStats) != 0 || fileStats.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* pView = mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pView == MAP_FAILED)
+		return false;
+
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_Size = static_cast<size_t>(fileStats.st_size);
+#endif
+
+	return true;
+}
+
+void Elite::MemoryMappedFile::Close()
+{
+	if (m_pData == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+#else
+	munmap(const_cast<uint8_t*>(m_pData), m_Size);
+#endif
+
+	m_pData = nullptr;
+	m_Size = 0;
+}
@@ -0,0 +1,51 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// EMemoryMappedFile.h: Read-only view of a whole file mapped into memory, used to load baked data without parsing it
+/*=============================================================================*/
+#ifndef ELITE_MEMORY_MAPPED_FILE
+#define	ELITE_MEMORY_MAPPED_FILE
+
+#include <cstdint>
+#include <string>
+
+namespace Elite
+{
+	class MemoryMappedFile final
+	{
+	public:
+		//=== Constructors & Destructors ===
+		MemoryMappedFile() = default;
+		explicit MemoryMappedFile(const std::string& filePath) { Open(filePath); }
+		~MemoryMappedFile() { Close(); }
+
+		//=== Functions ===
+		// Returns false if the file could not be opened or is empty
+		bool Open(const std::string& filePath);
+		void Close();
+
+		bool IsOpen() const { return m_pData != nullptr; }
+		const uint8_t* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+		// Returns a pointer to a T at the given byte offset, or nullptr if the file is too small to hold count of them
+		// Offsets and counts are 64-bit and never multiplied, so values from a corrupt header can't wrap past the check
+		template<typename T>
+		const T* GetAt(uint64_t offset, uint64_t count = 1) const
+		{
+			if (!m_pData || offset > m_Size || count > (m_Size - offset) / sizeof(T))
+				return nullptr;
+			return reinterpret_cast<const T*>(m_pData + size_t(offset));
+		}
+
+	private:
+		//=== Datamembers ===
+		const uint8_t* m_pData = nullptr;
+		size_t m_Size = 0;
+
+		//C++ make the class non-copyable
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+	};
+}
+#endif
@@ -0,0 +1,46 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+/*=============================================================================*/
+// ESpinBarrier.h: Reusable barrier for a fixed group of worker threads that sync many times per run (e.g. once per BFS level)
+/*=============================================================================*/
+#ifndef ELITE_SPIN_BARRIER
+#define	ELITE_SPIN_BARRIER
+
+#include <atomic>
+#include <thread>
+
+namespace Elite
+{
+	// Waiting spins with yields instead of sleeping, the phases between two waits are short
+	class SpinBarrier final
+	{
+	public:
+		//=== Constructors & Destructors ===
+		explicit SpinBarrier(int nrOfThreads) : m_NrOfThreads(nrOfThreads) {}
+
+		SpinBarrier(const SpinBarrier&) = delete;
+		SpinBarrier& operator=(const SpinBarrier&) = delete;
+
+		//=== Functions ===
+		// Returns once all threads have called Wait, everything written before is visible after
+		void Wait()
+		{
+			const int generation = m_Generation.load(std::memory_order_acquire);
+			if (m_Count.fetch_add(1, std::memory_order_acq_rel) + 1 == m_NrOfThreads)
+			{
+				m_Count.store(0, std::memory_order_relaxed);
+				m_Generation.fetch_add(1, std::memory_order_release);
+				return;
+			}
+
+			while (m_Generation.load(std::memory_order_acquire) == generation)
+				std::this_thread::yield();
+		}
+
+	private:
+		const int m_NrOfThreads;
+		std::atomic<int> m_Count{ 0 };
+		std::atomic<int> m_Generation{ 0 };
+	};
+}
+#endif
@@ -35,6 +35,8 @@
 	#include "projects\MachineLearning\App_MachineLearning.h"
 #elif defined(ActiveApp_JumpPointSearchPathfinding)
 	#include "projects\Movement\Pathfinding\PathfindingJPS\App_PathfindingJPS.h"
+#elif defined(ActiveApp_GraphTests)
+	#include "projects\Tests\App_GraphTests\App_GraphTests.h"
 #endif
 
 //Hotfix for genetic algorithms project
@@ -114,6 +116,8 @@ int main(int argc, char* argv[])
 		myApp = new App_MachineLearning();
 #elif defined(ActiveApp_JumpPointSearchPathfinding)
 		myApp = new App_PathfindingJPS();
+#elif defined(ActiveApp_GraphTests)
+		myApp = new App_GraphTests();
 #endif
 		ELITE_ASSERT(myApp, "Application has not been created.");
 		//Boot application
@@ -14,4 +14,5 @@
 //#define ActiveApp_InfluenceMap
 //#define ActiveApp_AgarioGame_IM
 //#define ActiveApp_MachineLearning
+//#define ActiveApp_GraphTests
 #define ActiveApp_JumpPointSearchPathfinding
\ No newline at end of file
@@ -10,6 +10,7 @@ using namespace Elite;
 //Destructor
 App_GraphTheory::~App_GraphTheory()
 {
+	SAFE_DELETE(m_pAllPairs);
 	SAFE_DELETE(m_pGraph2D);
 }
 
@@ -28,12 +29,19 @@ void App_GraphTheory::Start()
 	m_pGraph2D->AddNode(new GraphNode2D(0, Vector2{ 20.f, 30.f }));
 	m_pGraph2D->AddNode(new GraphNode2D(1, Vector2{ -10.f, -10.f }));
 	m_pGraph2D->AddConnection(new GraphConnection2D(0, 1));
+	m_pGraph2D->SetConnectionCostsToDistance();
+
+	m_pAllPairs = new AllPairsShortestPaths<GraphNode2D, GraphConnection2D>(m_pGraph2D);
+	m_pAllPairs->Build();
 }
 
 void App_GraphTheory::Update(float deltaTime)
 {
-	m_GraphEditor.UpdateGraph(m_pGraph2D);
-	m_pGraph2D->SetConnectionCostsToDistance();
+	if (m_GraphEditor.UpdateGraph(m_pGraph2D))
+	{
+		m_pGraph2D->SetConnectionCostsToDistance();
+		m_pAllPairs->Build();
+	}
 
 	auto eulerFinder = EulerianPath<GraphNode2D, GraphConnection2D>(m_pGraph2D);
 	auto isEuler = eulerFinder.IsEulerian();
@@ -116,6 +124,13 @@ void App_GraphTheory::Update(float deltaTime)
 		ImGui::Spacing();
 		ImGui::Spacing();
 
+		ImGui::Text("- All pairs:");
+		ImGui::Indent();
+		ImGui::Text("%.3f ms build", m_pAllPairs->GetLastBuildSeconds() * 1000.0);
+		ImGui::Unindent();
+		ImGui::Spacing();
+		ImGui::Spacing();
+
 		//End
 		ImGui::PopAllowKeyboardFocus();
 		ImGui::End();
@@ -10,6 +10,7 @@
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAllPairsShortestPaths.h"
 
 
 //-----------------------------------------------------------------
@@ -31,6 +32,7 @@ private:
 	Elite::Graph2D<Elite::GraphNode2D, Elite::GraphConnection2D>* m_pGraph2D = nullptr;
 	Elite::GraphRenderer m_GraphRenderer{};
 	Elite::GraphEditor m_GraphEditor{};
+	Elite::AllPairsShortestPaths<Elite::GraphNode2D, Elite::GraphConnection2D>* m_pAllPairs = nullptr;
 
 	//C++ make the class non-copyable
 	App_GraphTheory(const App_GraphTheory&) = delete;
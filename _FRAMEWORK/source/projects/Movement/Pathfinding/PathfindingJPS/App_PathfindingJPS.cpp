@@ -102,10 +102,10 @@ void App_PathfindingJPS::MakeGridGraph()
 	m_pGridGraph = new GridGraph<GridTerrainNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, true, 1.f, 2.f); // one bool == for diagonal paths allowed
 
 	//Setup default terrain
-	m_pGridGraph->GetNode(86)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(66)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(67)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(47)->SetTerrainType(TerrainType::Water);
+	m_pGridGraph->SetTerrainType(86, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(66, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(67, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(47, TerrainType::Water);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(86);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(66);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(67);
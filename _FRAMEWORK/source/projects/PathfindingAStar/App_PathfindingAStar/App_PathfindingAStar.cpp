@@ -5,12 +5,21 @@
 #include "App_PathfindingAStar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAstar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EDeltaStepping.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EMultiTargetDijkstra.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EParallelBFS.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EPathRepair.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EWeightedJPS.h"
 
 using namespace Elite;
 
 //Destructor
 App_PathfindingAStar::~App_PathfindingAStar()
 {
+	m_IsBackgroundSearchStopped = true;
+	if (m_BackgroundSearchThread.joinable())
+		m_BackgroundSearchThread.join();
+
 	SAFE_DELETE(m_pGridGraph);
 }
 
@@ -28,6 +37,9 @@ void App_PathfindingAStar::Start()
 	startPathIdx = 44;
 	endPathIdx = 88;
 	CalculatePath();
+
+	UpdateBackgroundQuery();
+	m_BackgroundSearchThread = std::thread(&App_PathfindingAStar::RunBackgroundSearches, this);
 }
 
 void App_PathfindingAStar::Update(float deltaTime)
@@ -60,8 +72,14 @@ void App_PathfindingAStar::Update(float deltaTime)
 	//UPDATE/CHECK GRID HAS CHANGED
 	if (m_GraphEditor.UpdateGraph(m_pGridGraph))
 	{
-		CalculatePath();
+		PublishGridSnapshot();
+		if (m_bRepairPathOnEdit && !m_vPath.empty())
+			RepairPath();
+		else
+			CalculatePath();
 	}
+
+	UpdateBackgroundQuery();
 }
 
 void App_PathfindingAStar::Render(float deltaTime) const
@@ -101,14 +119,114 @@ void App_PathfindingAStar::MakeGridGraph()
 	m_pGridGraph = new GridGraph<GridTerrainNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, false, 1.f, 1.5f); // one bool == for diagonal paths allowed
 
 	//Setup default terrain
-	m_pGridGraph->GetNode(86)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(66)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(67)->SetTerrainType(TerrainType::Water);
-	m_pGridGraph->GetNode(47)->SetTerrainType(TerrainType::Water);
+	m_pGridGraph->SetTerrainType(86, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(66, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(67, TerrainType::Water);
+	m_pGridGraph->SetTerrainType(47, TerrainType::Water);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(86);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(66);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(67);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(47);
+
+	PublishGridSnapshot();
+}
+
+void App_PathfindingAStar::PublishGridSnapshot()
+{
+	const GridSnapshot* pPrevious = m_GridVersions.GetLatest();
+	auto pSnapshot = GridSnapshot::FromGrid(*m_pGridGraph, pPrevious);
+	m_NrOfSharedChunks = pPrevious ? pSnapshot->GetNrOfSharedChunks(*pPrevious) : 0;
+	m_GridVersions.Publish(std::move(pSnapshot));
+}
+
+void App_PathfindingAStar::UpdateBackgroundQuery()
+{
+	// The grid can use another layout than the snapshots
+	auto toSnapshotIdx = [this](int idx) -> int
+	{
+		if (idx == invalid_node_index)
+			return invalid_node_index;
+
+		int col, row;
+		m_pGridGraph->GetColRow(idx, col, row);
+		return col + row * m_pGridGraph->GetColumns();
+	};
+
+	m_BackgroundStartIdx = toSnapshotIdx(startPathIdx);
+	m_BackgroundEndIdx = toSnapshotIdx(endPathIdx);
+}
+
+void App_PathfindingAStar::RunBackgroundSearches()
+{
+	int lastVersion = 0;
+	int lastStartIdx = invalid_node_index;
+	int lastEndIdx = invalid_node_index;
+
+	while (!m_IsBackgroundSearchStopped)
+	{
+		// The version stays alive while the reader is held, even when the main thread publishes a newer one
+		const VersionedGraph<GridSnapshot>::Reader reader = m_GridVersions.Read();
+		const int startIdx = m_BackgroundStartIdx;
+		const int endIdx = m_BackgroundEndIdx;
+		if (!reader || (reader.GetVersion() == lastVersion && startIdx == lastStartIdx && endIdx == lastEndIdx))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			continue;
+		}
+
+		// The query can be ahead of the version, e.g. right after loading a grid of another size
+		float pathCost = -1.f;
+		const int nrOfNodes = reader->GetNrOfNodes();
+		if (startIdx != invalid_node_index && endIdx != invalid_node_index && startIdx < nrOfNodes && endIdx < nrOfNodes)
+		{
+			float cost = 0.f;
+			if (!FindPathAStar(*reader, startIdx, endIdx, HeuristicFunctions::Octile, &cost).empty())
+				pathCost = cost;
+		}
+
+		m_BackgroundPathCost = pathCost;
+		m_BackgroundSearchVersion = reader.GetVersion();
+		lastVersion = reader.GetVersion();
+		lastStartIdx = startIdx;
+		lastEndIdx = endIdx;
+	}
+}
+
+void App_PathfindingAStar::SaveGridGraph() const
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	bool isSaved = m_pGridGraph->SaveToFile(m_GridFilePath);
+	float ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	if (isSaved)
+		std::cout << "Grid saved to " << m_GridFilePath << " in " << ms << " ms" << std::endl;
+	else
+		std::cout << "Couldn't save the grid to " << m_GridFilePath << std::endl;
+}
+
+void App_PathfindingAStar::LoadGridGraph()
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	bool isLoaded = m_pGridGraph->LoadFromFile(m_GridFilePath);
+	float ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	// A failed load leaves the grid as it was
+	if (!isLoaded)
+	{
+		std::cout << "Couldn't load a grid from " << m_GridFilePath << std::endl;
+		return;
+	}
+	std::cout << "Grid loaded from " << m_GridFilePath << " in " << ms << " ms" << std::endl;
+
+	// The file can hold a grid of another size
+	const int nrOfCells = m_pGridGraph->GetColumns() * m_pGridGraph->GetRows();
+	if (startPathIdx >= nrOfCells)
+		startPathIdx = invalid_node_index;
+	if (endPathIdx >= nrOfCells)
+		endPathIdx = invalid_node_index;
+
+	PublishGridSnapshot();
+	CalculatePath();
 }
 
 void App_PathfindingAStar::UpdateImGui()
@@ -160,10 +278,41 @@ void App_PathfindingAStar::UpdateImGui()
 			m_StartSelected = !m_StartSelected;
 		}
 
+		if (ImGui::Button("Path to nearest Mud"))
+		{
+			CalculatePathToNearestMud();
+		}
+
+		if (ImGui::Button("Save grid"))
+		{
+			SaveGridGraph();
+		}
+
+		if (ImGui::Button("Load grid"))
+		{
+			LoadGridGraph();
+		}
+
+		if (ImGui::Button("Bench layouts"))
+		{
+			BenchmarkGridLayouts();
+		}
+
+		if (ImGui::Button("Bench BFS"))
+		{
+			BenchmarkParallelBFS();
+		}
+
+		if (ImGui::Button("Bench SSSP"))
+		{
+			BenchmarkDeltaStepping();
+		}
+
 		ImGui::Checkbox("Grid", &m_bDrawGrid);
 		ImGui::Checkbox("NodeNumbers", &m_bDrawNodeNumbers);
 		ImGui::Checkbox("Connections", &m_bDrawConnections);
 		ImGui::Checkbox("Connections Costs", &m_bDrawConnectionsCosts);
+		ImGui::Checkbox("Repair on edit", &m_bRepairPathOnEdit);
 		if (ImGui::Combo("", &m_SelectedHeuristic, "Manhattan\0Euclidean\0SqrtEuclidean\0Octile\0Chebyshev", 4))
 		{
 			switch (m_SelectedHeuristic)
@@ -187,7 +336,19 @@ void App_PathfindingAStar::UpdateImGui()
 				m_pHeuristicFunction = HeuristicFunctions::Chebyshev;
 				break;
 			}
+			CalculatePath();
 		}
+
+		ImGui::Spacing();
+		if (ImGui::Combo("Search", &m_SelectedSearchMode, "Optimal\0Weighted A*\0Focal", 3))
+			CalculatePath();
+		if (m_SelectedSearchMode != int(SearchMode::Optimal) && ImGui::SliderFloat("Epsilon", &m_SuboptimalityBound, 0.f, 2.f, "%.2f"))
+			CalculatePath();
+		ImGui::Text("Expanded: %d (optimal %d)", m_NrOfExpandedNodes, m_NrOfOptimalExpandedNodes);
+		ImGui::Text("Cost: %.1f (optimal %.1f)", m_PathCost, m_OptimalPathCost);
+		ImGui::Text("Grid version %d", m_GridVersions.GetLatestVersion());
+		ImGui::Text("Shared chunks: %d", m_NrOfSharedChunks);
+		ImGui::Text("Background v%d: %.1f", m_BackgroundSearchVersion.load(), m_BackgroundPathCost.load());
 		ImGui::Spacing();
 
 		//End
@@ -207,12 +368,23 @@ void App_PathfindingAStar::CalculatePath()
 	{
 		//BFS Pathfinding
 		//auto pathfinder = BFS<GridTerrainNode, GraphConnection>(m_pGridGraph);
-		auto pathfinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+		const IGraphView<GridTerrainNode, GraphConnection> gridView{ m_pGridGraph };
+		auto pathfinder = AStar<IGraphView<GridTerrainNode, GraphConnection>>(&gridView, m_pHeuristicFunction);
 		auto startNode = m_pGridGraph->GetNode(startPathIdx);
 		auto endNode = m_pGridGraph->GetNode(endPathIdx);
 
+		// The optimal search runs first as reference for the expansion savings
 		m_vPath = pathfinder.FindPath(startNode, endNode);
+		m_NrOfOptimalExpandedNodes = pathfinder.GetLastSearchStats().nrOfExpandedNodes;
+		m_OptimalPathCost = pathfinder.GetLastSearchStats().pathCost;
 
+		if (m_SelectedSearchMode != int(SearchMode::Optimal))
+		{
+			pathfinder.SetSearchMode(SearchMode(m_SelectedSearchMode), m_SuboptimalityBound);
+			m_vPath = pathfinder.FindPath(startNode, endNode);
+		}
+		m_NrOfExpandedNodes = pathfinder.GetLastSearchStats().nrOfExpandedNodes;
+		m_PathCost = pathfinder.GetLastSearchStats().pathCost;
 
 		std::cout << "New Path Calculated" << std::endl;
 	}
@@ -222,3 +394,162 @@ void App_PathfindingAStar::CalculatePath()
 		m_vPath.clear();
 	}
 }
+
+void App_PathfindingAStar::RepairPath()
+{
+	using Repair = PathRepair<GridTerrainNode, GraphConnection>;
+	const char* resultNames[] = { "Path unchanged", "Path repaired", "Path replanned", "No path after edit" };
+
+	Repair pathRepair{ m_pGridGraph, m_pHeuristicFunction };
+	Repair::RepairResult result = pathRepair.Repair(m_vPath);
+
+	m_NrOfExpandedNodes = pathRepair.GetLastNrOfExpandedNodes();
+	m_PathCost = 0.f;
+	for (size_t i = 1; i < m_vPath.size(); ++i)
+		m_PathCost += m_pGridGraph->GetConnection(m_vPath[i - 1]->GetIndex(), m_vPath[i]->GetIndex())->GetCost();
+
+	std::cout << resultNames[int(result)] << " (" << m_NrOfExpandedNodes << " expansions)" << std::endl;
+}
+
+void App_PathfindingAStar::CalculatePathToNearestMud()
+{
+	if (startPathIdx == invalid_node_index)
+		return;
+
+	auto pathfinder = MultiTargetDijkstra<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	auto isMud = [this](int idx) { return m_pGridGraph->GetTerrainType(idx) == TerrainType::Mud; };
+
+	int mudIdx = invalid_node_index;
+	float pathCost = 0.f;
+	m_vPath = pathfinder.FindPathToNearest(m_pGridGraph->GetNode(startPathIdx), isMud, mudIdx, pathCost);
+
+	if (mudIdx == invalid_node_index)
+	{
+		std::cout << "No reachable Mud..." << std::endl;
+		return;
+	}
+
+	endPathIdx = mudIdx;
+	std::cout << "Nearest Mud at node " << mudIdx << ", cost " << pathCost << std::endl;
+}
+
+void App_PathfindingAStar::BenchmarkGridLayouts() const
+{
+	const int mapSizes[] = { 64, 256, 1024 };
+	const GridLayout layouts[] = { GridLayout::RowMajor, GridLayout::Tiled };
+	const char* layoutNames[] = { "RowMajor", "Tiled" };
+	const int nrOfQueries = 200;
+
+	for (int mapSize : mapSizes)
+	{
+		for (int l = 0; l < 2; ++l)
+		{
+			// Same seed for every layout, so each one gets the same map and the same queries
+			srand(mapSize);
+
+			GridGraph<GridTerrainNode, GraphConnection> grid{ mapSize, mapSize, 1, false, true, 1.f, 1.5f, layouts[l] };
+			for (int r = 0; r < mapSize; ++r)
+			{
+				for (int c = 0; c < mapSize; ++c)
+				{
+					int roll = randomInt(10);
+					if (roll == 0)
+						grid.SetTerrainType(grid.GetIndex(c, r), TerrainType::Water);
+					else if (roll < 3)
+						grid.SetTerrainType(grid.GetIndex(c, r), TerrainType::Mud);
+				}
+			}
+			grid.RebuildConnections();
+
+			WeightedJPS<GridTerrainNode, GraphConnection> pathfinder{ &grid, HeuristicFunctions::Chebyshev };
+			size_t totalPathLength = 0;
+
+			auto startTime = std::chrono::high_resolution_clock::now();
+			for (int q = 0; q < nrOfQueries; ++q)
+			{
+				auto pStart = grid.GetNode(randomInt(mapSize), randomInt(mapSize));
+				auto pGoal = grid.GetNode(randomInt(mapSize), randomInt(mapSize));
+				totalPathLength += pathfinder.FindPath(pStart, pGoal).size();
+			}
+			auto endTime = std::chrono::high_resolution_clock::now();
+
+			float totalMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+			std::cout << mapSize << "x" << mapSize << " " << layoutNames[l] << ": "
+				<< totalMs / nrOfQueries << " ms/query (total path length " << totalPathLength << ")" << std::endl;
+		}
+	}
+}
+
+void App_PathfindingAStar::BenchmarkParallelBFS() const
+{
+	const int mapSizes[] = { 256, 1024 };
+	const char* modeNames[] = { "top-down 1 thread", "top-down", "direction-optimizing" };
+
+	for (int mapSize : mapSizes)
+	{
+		srand(mapSize);
+
+		GridGraph<GridTerrainNode, GraphConnection> grid{ mapSize, mapSize, 1, false, true };
+		for (int idx = 0; idx < grid.GetNrOfNodes(); ++idx)
+		{
+			if (randomInt(10) == 0)
+				grid.SetTerrainType(idx, TerrainType::Water);
+		}
+		grid.RebuildConnections();
+
+		ParallelBFS<GridTerrainNode, GraphConnection> bfs{ &grid };
+		bfs.Build();
+
+		const std::vector<int> sources{ grid.GetIndex(mapSize / 2, mapSize / 2) };
+		std::vector<int> depths{};
+		for (int mode = 0; mode < 3; ++mode)
+		{
+			bfs.Run(sources, depths, mode == 0 ? 1 : 0, mode == 2);
+
+			const auto& stats = bfs.GetLastStats();
+			std::cout << mapSize << "x" << mapSize << " " << modeNames[mode] << ": "
+				<< stats.seconds * 1000.0 << " ms, " << stats.GetEdgesPerSecond() / 1e6 << " MTEPS ("
+				<< stats.nrOfLevels << " levels, " << stats.nrOfBottomUpLevels << " bottom-up)" << std::endl;
+		}
+	}
+}
+
+void App_PathfindingAStar::BenchmarkDeltaStepping() const
+{
+	const int mapSizes[] = { 256, 1024 };
+
+	for (int mapSize : mapSizes)
+	{
+		srand(mapSize);
+
+		GridGraph<GridTerrainNode, GraphConnection> grid{ mapSize, mapSize, 1, false, true };
+		for (int idx = 0; idx < grid.GetNrOfNodes(); ++idx)
+		{
+			int roll = randomInt(10);
+			if (roll == 0)
+				grid.SetTerrainType(idx, TerrainType::Water);
+			else if (roll < 3)
+				grid.SetTerrainType(idx, TerrainType::Mud);
+		}
+		grid.RebuildConnections();
+
+		auto pSource = grid.GetNode(mapSize / 2, mapSize / 2);
+
+		// A target that never matches makes the Dijkstra settle the whole map
+		MultiTargetDijkstra<GridTerrainNode, GraphConnection> dijkstra{ &grid };
+		int foundTargetIdx;
+		float pathCost;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		dijkstra.FindPathToNearest(pSource, [](int) { return false; }, foundTargetIdx, pathCost);
+		float dijkstraMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		DeltaStepping<GridTerrainNode, GraphConnection> deltaStepping{ &grid };
+		deltaStepping.Build();
+		std::vector<float> distances{};
+		deltaStepping.Run({ pSource->GetIndex() }, distances);
+
+		const auto& stats = deltaStepping.GetLastStats();
+		std::cout << mapSize << "x" << mapSize << ": Dijkstra " << dijkstraMs << " ms, delta-stepping "
+			<< stats.seconds * 1000.0 << " ms (" << stats.nrOfBuckets << " buckets, " << stats.nrOfRelaxations << " relaxations)" << std::endl;
+	}
+}
@@ -7,6 +7,8 @@
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphSnapshots.h"
+#include <thread>
 
 
 //-----------------------------------------------------------------
@@ -35,6 +37,7 @@ private:
 	static const int ROWS = 10;
 	unsigned int m_SizeCell = 15;
 	Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>* m_pGridGraph;
+	const std::string m_GridFilePath{ "GridGraph.bin" };
 
 
 	//Pathfinding datamembers
@@ -42,6 +45,18 @@ private:
 	int endPathIdx = invalid_node_index;
 	std::vector<Elite::GridTerrainNode*> m_vPath;
 
+	// Published after every edit, the background search reads these instead of m_pGridGraph
+	Elite::VersionedGraph<Elite::GridSnapshot> m_GridVersions{};
+	int m_NrOfSharedChunks = 0; // with the previous version
+
+	// Background search between the start and end cells, always on the latest version while the grid is being edited
+	std::thread m_BackgroundSearchThread{};
+	std::atomic<bool> m_IsBackgroundSearchStopped{ false };
+	std::atomic<int> m_BackgroundStartIdx{ invalid_node_index }; // row-major, the indices of GridSnapshot
+	std::atomic<int> m_BackgroundEndIdx{ invalid_node_index };
+	std::atomic<int> m_BackgroundSearchVersion{ 0 }; // of the last finished search
+	std::atomic<float> m_BackgroundPathCost{ 0.f }; // -1 when there is no path
+
 	//Editor and Visualisation
 	Elite::GraphEditor m_GraphEditor{};
 	Elite::GraphRenderer m_GraphRenderer{};
@@ -52,13 +67,38 @@ private:
 	bool m_bDrawConnections = false;
 	bool m_bDrawConnectionsCosts = false;
 	bool m_StartSelected = true;
+	bool m_bRepairPathOnEdit = true;
 	int m_SelectedHeuristic = 4;
 	Elite::Heuristic m_pHeuristicFunction = Elite::HeuristicFunctions::Chebyshev;
+	int m_SelectedSearchMode = 0;
+	float m_SuboptimalityBound = 0.5f;
+	int m_NrOfExpandedNodes = 0;
+	int m_NrOfOptimalExpandedNodes = 0; // same query in SearchMode::Optimal, to show what the bounded modes save
+	float m_PathCost = 0.f;
+	float m_OptimalPathCost = 0.f;
 
 	//Functions
 	void MakeGridGraph();
+	void PublishGridSnapshot();
+	// Hands the start and end cells to the background search
+	void UpdateBackgroundQuery();
+	// Runs on m_BackgroundSearchThread until the app closes, searches again when the version or the query changed
+	void RunBackgroundSearches();
+	// Bakes the grid to m_GridFilePath and replaces it with what is in that file, both print how long they took
+	void SaveGridGraph() const;
+	void LoadGridGraph();
 	void UpdateImGui();
 	void CalculatePath();
+	// Fixes the current path locally after an edit, expansions and cost are compared against the last full CalculatePath
+	void RepairPath();
+	// Paths from the start node to the nearest Mud cell in one search, the end node moves there
+	void CalculatePathToNearestMud();
+	// Times the same queries on every GridLayout for a few map sizes and prints the results
+	void BenchmarkGridLayouts() const;
+	// Floods big grids with ParallelBFS in its different modes and prints the traversed edges per second
+	void BenchmarkParallelBFS() const;
+	// Full cost field from the map's center, single-threaded Dijkstra against DeltaStepping on all cores
+	void BenchmarkDeltaStepping() const;
 
 	//C++ make the class non-copyable
 	App_PathfindingAStar(const App_PathfindingAStar&) = delete;
@@ -0,0 +1,925 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "App_GraphTests.h"
+#include "framework\EliteAI\EliteGraphs\ENavGraph.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ECompressedPathDatabase.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EPathRepair.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ESubgoalGraph.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EWeightedJPS.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphSnapshots.h"
+#include "framework\EliteHelpers\EEpochManager.h"
+#include <fstream>
+#include <queue>
+#include <thread>
+
+using namespace Elite;
+
+//Functions
+void App_GraphTests::Start()
+{
+	RunTests();
+}
+
+void App_GraphTests::Update(float deltaTime)
+{
+	UNREFERENCED_PARAMETER(deltaTime);
+
+	UpdateImGui();
+}
+
+void App_GraphTests::Render(float deltaTime) const
+{
+	UNREFERENCED_PARAMETER(deltaTime);
+}
+
+void App_GraphTests::RunTests()
+{
+	m_TestResults.clear();
+	m_TestResults.push_back(TestGridGraphFiles());
+	m_TestResults.push_back(TestNavGraphFiles());
+	m_TestResults.push_back(TestWeightedJPS());
+	m_TestResults.push_back(TestSubgoalGraph());
+	m_TestResults.push_back(TestCompressedPathDatabase());
+	m_TestResults.push_back(TestGoalBounding());
+	m_TestResults.push_back(TestFixedPointAStar());
+	m_TestResults.push_back(TestPathRepair());
+	m_TestResults.push_back(StressEpochManager());
+	m_TestResults.push_back(StressGraphSnapshots());
+
+	for (const TestResult& result : m_TestResults)
+	{
+		std::cout << result.name << ": " << (result.nrOfFailures == 0 ? "passed" : "FAILED") << " ("
+			<< result.nrOfFailures << " of " << result.nrOfChecks << " checks failed)" << std::endl;
+	}
+}
+
+void App_GraphTests::UpdateImGui()
+{
+#ifdef PLATFORM_WINDOWS
+#pragma region UI
+	//UI
+	{
+		//Setup
+		int menuWidth = 200;
+		int const width = DEBUGRENDERER2D->GetActiveCamera()->GetWidth();
+		int const height = DEBUGRENDERER2D->GetActiveCamera()->GetHeight();
+		bool windowActive = true;
+		ImGui::SetNextWindowPos(ImVec2((float)width - menuWidth - 10, 10));
+		ImGui::SetNextWindowSize(ImVec2((float)menuWidth, (float)height - 20));
+		ImGui::Begin("Graph Tests", &windowActive, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+		ImGui::PushAllowKeyboardFocus(false);
+
+		//Elements
+		if (ImGui::Button("Run tests"))
+		{
+			RunTests();
+		}
+
+		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
+
+		for (const TestResult& result : m_TestResults)
+		{
+			ImGui::Text("%s", result.name.c_str());
+			ImGui::Indent();
+			ImGui::Text("%s: %d/%d failed", result.nrOfFailures == 0 ? "passed" : "FAILED", result.nrOfFailures, result.nrOfChecks);
+			ImGui::Unindent();
+		}
+
+		//End
+		ImGui::PopAllowKeyboardFocus();
+		ImGui::End();
+	}
+#pragma endregion
+#endif
+}
+
+App_GraphTests::TestResult App_GraphTests::TestGridGraphFiles() const
+{
+	using namespace GraphFileFormat;
+	TestResult result{ "Grid graph files" };
+	const std::string filePath{ "GraphTests_grid.bin" };
+	const int nrOfReaders = 4;
+
+	srand(28);
+	for (int trial = 0; trial < 24; ++trial)
+	{
+		// Both layouts, with and without diagonals and direction
+		const GridLayout layout = trial % 2 == 0 ? GridLayout::RowMajor : GridLayout::Tiled;
+		Grid grid{ 1 + randomInt(40), 1 + randomInt(40), 1 + randomInt(10), trial % 4 == 3, trial % 3 != 0, 1.f, 1.5f, layout };
+		RandomizeTerrain(grid, 15, 20);
+
+		// Connections the terrain doesn't generate: added, removed and with another cost
+		for (int edit = 0; edit < 20; ++edit)
+		{
+			const int fromIdx = randomInt(grid.GetNrOfNodes());
+			int toIdx = randomInt(grid.GetNrOfNodes());
+			const auto& connections = grid.GetConnections(fromIdx);
+			if (randomInt(2) == 0 && !connections.empty())
+				toIdx = (*std::next(connections.begin(), randomInt(int(connections.size()))))->GetTo();
+			if (fromIdx == toIdx)
+				continue;
+
+			GraphConnection* pConnection = grid.GetConnection(fromIdx, toIdx);
+			if (pConnection == nullptr)
+				grid.AddConnection(new GraphConnection(fromIdx, toIdx, float(1 + randomInt(20))));
+			else if (randomInt(2) == 0)
+				pConnection->SetCost(float(1 + randomInt(20)));
+			else
+				grid.RemoveConnection(fromIdx, toIdx);
+		}
+
+		Grid loaded{ false };
+		++result.nrOfChecks;
+		if (!grid.SaveToFile(filePath) || !loaded.LoadFromFile(filePath))
+		{
+			++result.nrOfFailures;
+			continue;
+		}
+
+		// The nodes and connections are created on first use, every reader racing for that has to see all of them
+		const int nrOfConnections = grid.GetNrOfConnections();
+		const int nrOfCells = loaded.GetColumns() * loaded.GetRows();
+		std::atomic<int> nrOfIncompleteReads{ 0 };
+		std::vector<std::thread> readers{};
+		for (int i = 0; i < nrOfReaders; ++i)
+		{
+			readers.emplace_back([&]()
+			{
+				int nrOfReadConnections = 0;
+				for (int idx = 0; idx < nrOfCells; ++idx)
+					nrOfReadConnections += int(loaded.GetConnections(idx).size());
+				if (nrOfReadConnections != nrOfConnections)
+					++nrOfIncompleteReads;
+			});
+		}
+		for (std::thread& reader : readers)
+			reader.join();
+
+		if (nrOfIncompleteReads != 0 || !AreGridsEqual(grid, loaded))
+			++result.nrOfFailures;
+	}
+
+	// Damaged copies of a valid file
+	Grid grid{ 16, 16, 1, false, true };
+	RandomizeTerrain(grid, 15, 20);
+	grid.SaveToFile(filePath);
+	std::ifstream file{ filePath, std::ios::binary };
+	const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	file.close();
+
+	auto getHeader = [](std::string& damagedBytes) { return reinterpret_cast<GridGraphHeader*>(&damagedBytes[0]); };
+	const std::vector<std::function<void(std::string&)>> damages
+	{
+		[](std::string& damagedBytes) { damagedBytes.resize(damagedBytes.size() / 2); },
+		[](std::string& damagedBytes) { damagedBytes.resize(sizeof(GridGraphHeader) - 1); },
+		[getHeader](std::string& damagedBytes) { ++getHeader(damagedBytes)->version; },
+		[getHeader](std::string& damagedBytes) { getHeader(damagedBytes)->columns = 0; },
+		[getHeader](std::string& damagedBytes) { getHeader(damagedBytes)->columns = getHeader(damagedBytes)->rows = 0x10000; },
+		[getHeader](std::string& damagedBytes) { getHeader(damagedBytes)->nrOfCostOverrides = 0xFFFFFFFF; },
+		[](std::string& damagedBytes) { damagedBytes[sizeof(GridGraphHeader) + 7] = char(TerrainTypeToByte(TerrainType::Water) + 1); }
+	};
+	for (const auto& damage : damages)
+	{
+		std::string damagedBytes = bytes;
+		damage(damagedBytes);
+		std::ofstream{ filePath, std::ios::binary }.write(damagedBytes.data(), damagedBytes.size());
+
+		Grid target{ 3, 2, 1, false, true };
+		++result.nrOfChecks;
+		if (target.LoadFromFile(filePath) || target.GetColumns() != 3 || target.GetRows() != 2 || target.GetNrOfNodes() != 6)
+			++result.nrOfFailures;
+	}
+
+	std::remove(filePath.c_str());
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestNavGraphFiles() const
+{
+	using namespace GraphFileFormat;
+	TestResult result{ "Navigation graph files" };
+	const std::string filePath{ "GraphTests_navmesh.bin" };
+
+	// A square cut into two triangles along its diagonal (line 2), a node on the diagonal and one on the bottom edge
+	struct NavFile
+	{
+		NavGraphHeader header;
+		std::vector<PolygonChild> children;
+		std::vector<Point> points;
+		std::vector<TriangleRecord> triangles;
+		std::vector<LineRecord> lines;
+		std::vector<NodeRecord> nodes;
+		std::vector<ConnectionRecord> connections;
+	};
+
+	NavFile validFile{};
+	validFile.points = { { 0.f, 0.f }, { 10.f, 0.f }, { 10.f, 10.f }, { 0.f, 10.f } };
+	const Point* p = validFile.points.data();
+	validFile.triangles = { { { p[0], p[1], p[2] }, { 0, 1, 2 } }, { { p[0], p[2], p[3] }, { 2, 3, 4 } } };
+	validFile.lines = { { p[0], p[1], 0 }, { p[1], p[2], 1 }, { p[2], p[0], 2 }, { p[2], p[3], 3 }, { p[3], p[0], 4 } };
+	validFile.nodes = { { 2, { 5.f, 5.f } }, { 0, { 5.f, 0.f } } };
+	validFile.connections = { { 0, 1, 5.f }, { 1, 0, 5.f } };
+	validFile.header = { NavGraphMagic, NavGraphVersion, 4, 0, 4, 2, 5, 2, 2 };
+
+	auto load = [&filePath](const NavFile& navFile)
+	{
+		std::ofstream file{ filePath, std::ios::binary };
+		auto write = [&file](const auto& records) { file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(records[0])); };
+		file.write(reinterpret_cast<const char*>(&navFile.header), sizeof(navFile.header));
+		write(navFile.children);
+		write(navFile.points);
+		write(navFile.triangles);
+		write(navFile.lines);
+		write(navFile.nodes);
+		write(navFile.connections);
+		file.close();
+
+		return NavGraph::LoadFromFile(filePath);
+	};
+
+	NavGraph* pNavGraph = load(validFile);
+	++result.nrOfChecks;
+	if (pNavGraph == nullptr || pNavGraph->GetNrOfNodes() != 2 || pNavGraph->GetNrOfConnections() != 2
+		|| pNavGraph->GetNavMeshPolygon()->GetLines().size() != 5)
+		++result.nrOfFailures;
+	SAFE_DELETE(pNavGraph);
+
+	const std::vector<std::function<void(NavFile&)>> damages
+	{
+		[](NavFile& navFile) { navFile.triangles[1].lineIndices[2] = 5; },
+		[](NavFile& navFile) { navFile.triangles[0].lineIndices[0] = -1; },
+		[](NavFile& navFile) { navFile.lines[3].index = 4; },
+		[](NavFile& navFile) { navFile.nodes[1].lineIndex = 5; },
+		[](NavFile& navFile) { navFile.nodes[0].lineIndex = -2; },
+		[](NavFile& navFile) { navFile.connections[0].to = 2; },
+		[](NavFile& navFile) { navFile.connections[1].from = -1; },
+		[](NavFile& navFile) { navFile.connections[1].to = 1; },
+		[](NavFile& navFile) { navFile.children = { { 1 } }; navFile.header.nrOfChildren = 1; },
+		[](NavFile& navFile) { navFile.header.nrOfOuterPoints = 5; }
+	};
+	for (const auto& damage : damages)
+	{
+		NavFile damagedFile = validFile;
+		damage(damagedFile);
+
+		pNavGraph = load(damagedFile);
+		++result.nrOfChecks;
+		if (pNavGraph != nullptr)
+			++result.nrOfFailures;
+		SAFE_DELETE(pNavGraph);
+	}
+
+	std::remove(filePath.c_str());
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestWeightedJPS() const
+{
+	TestResult result{ "Weighted JPS" };
+
+	srand(32);
+	for (int trial = 0; trial < 30; ++trial)
+	{
+		// Both layouts, every third grid only connects straight, more Mud every trial
+		const GridLayout layout = trial % 2 == 0 ? GridLayout::RowMajor : GridLayout::Tiled;
+		Grid grid{ 2 + randomInt(30), 2 + randomInt(30), 1, false, trial % 3 != 0, 1.f, 1.5f, layout };
+		RandomizeTerrain(grid, 15, 2 * trial);
+
+		WeightedJPS<GridTerrainNode, GraphConnection> pathfinder{ &grid, HeuristicFunctions::Chebyshev };
+		for (int query = 0; query < 40; ++query)
+		{
+			const int agentSize = 1 + query % 2;
+			const int startIdx = randomInt(grid.GetNrOfNodes());
+			const int goalIdx = randomInt(grid.GetNrOfNodes());
+			if (!grid.CanFitAgent(startIdx, agentSize) || !grid.CanFitAgent(goalIdx, agentSize))
+				continue;
+
+			const std::vector<GridTerrainNode*> path = pathfinder.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx), agentSize);
+
+			++result.nrOfChecks;
+			if (abs(GetPathCost(grid, path) - GetReferenceCost(grid, startIdx, goalIdx, agentSize)) > 1e-3f || !IsPathWalkable(grid, path, 0, agentSize)
+				|| (!path.empty() && (path.front()->GetIndex() != startIdx || path.back()->GetIndex() != goalIdx)))
+				++result.nrOfFailures;
+		}
+	}
+
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestSubgoalGraph() const
+{
+	using Subgoals = SubgoalGraph<GridTerrainNode, GraphConnection>;
+	TestResult result{ "Subgoal graph" };
+
+	srand(34);
+	for (int trial = 0; trial < 20; ++trial)
+	{
+		// Both layouts, every other graph is built for agents of size 2, no Mud (costs have to be uniform)
+		const GridLayout layout = trial % 2 == 0 ? GridLayout::RowMajor : GridLayout::Tiled;
+		const int agentSize = 1 + (trial / 2) % 2;
+		Grid grid{ 2 + randomInt(30), 2 + randomInt(30), 1, false, true, 1.f, 1.5f, layout };
+		RandomizeTerrain(grid, 10 + trial, 0);
+
+		Subgoals subgoals{ &grid };
+		subgoals.Build(agentSize);
+
+		std::vector<std::pair<int, int>> queries{};
+		std::vector<float> costs{};
+		for (int query = 0; query < 40; ++query)
+		{
+			const int startIdx = randomInt(grid.GetNrOfNodes());
+			const int goalIdx = randomInt(grid.GetNrOfNodes());
+			if (!grid.CanFitAgent(startIdx, agentSize) || !grid.CanFitAgent(goalIdx, agentSize))
+				continue;
+
+			const std::vector<GridTerrainNode*> path = subgoals.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx));
+			const float cost = GetPathCost(grid, path);
+			queries.push_back({ startIdx, goalIdx });
+			costs.push_back(cost);
+
+			++result.nrOfChecks;
+			if (abs(cost - GetReferenceCost(grid, startIdx, goalIdx, agentSize)) > 1e-3f || !IsPathWalkable(grid, path, 0, agentSize)
+				|| (!path.empty() && (path.front()->GetIndex() != startIdx || path.back()->GetIndex() != goalIdx)))
+				++result.nrOfFailures;
+		}
+
+		// The same queries from several threads at once find the same paths
+		std::atomic<int> nrOfThreadFailures{ 0 };
+		std::vector<std::thread> threads{};
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&]()
+				{
+					for (size_t query = 0; query < queries.size(); ++query)
+					{
+						const int startIdx = queries[query].first;
+						const int goalIdx = queries[query].second;
+						if (GetPathCost(grid, subgoals.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx))) != costs[query])
+							++nrOfThreadFailures;
+					}
+				});
+		}
+		for (auto& thread : threads)
+			thread.join();
+
+		++result.nrOfChecks;
+		if (nrOfThreadFailures != 0)
+			++result.nrOfFailures;
+	}
+
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestCompressedPathDatabase() const
+{
+	using namespace GraphFileFormat;
+	using Database = CompressedPathDatabase<GridTerrainNode, GraphConnection>;
+	TestResult result{ "Compressed path database" };
+	const std::string filePath{ "GraphTests_paths.bin" };
+
+	srand(35);
+	for (int trial = 0; trial < 20; ++trial)
+	{
+		// Both layouts, every third grid only connects straight
+		const GridLayout layout = trial % 2 == 0 ? GridLayout::RowMajor : GridLayout::Tiled;
+		Grid grid{ 2 + randomInt(30), 2 + randomInt(30), 1, false, trial % 3 != 0, 1.f, 1.5f, layout };
+		RandomizeTerrain(grid, 20, 20);
+
+		Database database{ &grid };
+		database.Build(1 + trial % 4);
+
+		Database loaded{ &grid };
+		++result.nrOfChecks;
+		if (!database.SaveToFile(filePath) || !loaded.LoadFromFile(filePath))
+			++result.nrOfFailures;
+
+		for (int query = 0; query < 40; ++query)
+		{
+			const int startIdx = randomInt(grid.GetNrOfNodes());
+			const int goalIdx = randomInt(grid.GetNrOfNodes());
+			if (!grid.IsWalkable(startIdx) || !grid.IsWalkable(goalIdx))
+				continue;
+
+			// A path exactly when one exists, and it is a cheapest one
+			const float referenceCost = GetReferenceCost(grid, startIdx, goalIdx);
+			const float cost = GetPathCost(grid, database.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx)));
+			const float loadedCost = loaded.IsBuilt() ? GetPathCost(grid, loaded.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx))) : -1.f;
+
+			++result.nrOfChecks;
+			if (abs(cost - referenceCost) > 1e-3f || abs(loadedCost - referenceCost) > 1e-3f)
+				++result.nrOfFailures;
+		}
+	}
+
+	// Damaged copies of a valid file, source 0 is the top left cell in which the first run starts at target 0
+	Grid grid{ 12, 12, 1, false, true };
+	RandomizeTerrain(grid, 15, 20);
+	grid.SetTerrainType(0, TerrainType::Ground);
+	Database database{ &grid };
+	database.Build();
+	database.SaveToFile(filePath);
+	std::ifstream file{ filePath, std::ios::binary };
+	const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	file.close();
+
+	const size_t runsOffset = sizeof(PathDatabaseHeader) + (grid.GetNrOfNodes() + 1) * sizeof(uint32_t);
+	auto getHeader = [](std::string& damagedBytes) { return reinterpret_cast<PathDatabaseHeader*>(&damagedBytes[0]); };
+	auto getRun = [runsOffset](std::string& damagedBytes, size_t i) { return reinterpret_cast<uint32_t*>(&damagedBytes[runsOffset + i * sizeof(uint32_t)]); };
+	const std::vector<std::function<void(std::string&)>> damages
+	{
+		[](std::string& damagedBytes) { damagedBytes.resize(damagedBytes.size() - 1); },
+		[getHeader](std::string& damagedBytes) { ++getHeader(damagedBytes)->columns; },
+		[getHeader](std::string& damagedBytes) { getHeader(damagedBytes)->flags = GridFlag_TiledLayout; },
+		// A move past the 8 directions
+		[getRun](std::string& damagedBytes) { *getRun(damagedBytes, 0) = (*getRun(damagedBytes, 0) & ~0xFu) | 8; },
+		// Left from the top left cell
+		[getRun](std::string& damagedBytes) { *getRun(damagedBytes, 0) = (*getRun(damagedBytes, 0) & ~0xFu) | 2; },
+		// A target past the last cell, and two runs for the same target
+		[getRun](std::string& damagedBytes) { *getRun(damagedBytes, 0) = (12 * 12) << 4; },
+		[getRun](std::string& damagedBytes) { *getRun(damagedBytes, 1) = *getRun(damagedBytes, 0); }
+	};
+	for (const auto& damage : damages)
+	{
+		std::string damagedBytes = bytes;
+		damage(damagedBytes);
+		std::ofstream{ filePath, std::ios::binary }.write(damagedBytes.data(), damagedBytes.size());
+
+		Database target{ &grid };
+		++result.nrOfChecks;
+		if (target.LoadFromFile(filePath) || target.IsBuilt())
+			++result.nrOfFailures;
+	}
+
+	std::remove(filePath.c_str());
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestGoalBounding() const
+{
+	using namespace GraphFileFormat;
+	using Bounds = GoalBounding<GridTerrainNode, GraphConnection>;
+	using View = GridGraphView<GridTerrainNode, GraphConnection>;
+	TestResult result{ "Goal bounding" };
+	const std::string filePath{ "GraphTests_bounds.bin" };
+
+	srand(41);
+	for (int trial = 0; trial < 20; ++trial)
+	{
+		// Both layouts, every third grid only connects straight, every other one is built for agents of size 2
+		const GridLayout layout = trial % 2 == 0 ? GridLayout::RowMajor : GridLayout::Tiled;
+		const int agentSize = 1 + trial % 2;
+		Grid grid{ 2 + randomInt(30), 2 + randomInt(30), 1, false, trial % 3 != 0, 1.f, 1.5f, layout };
+		RandomizeTerrain(grid, 15, 20);
+
+		Bounds bounds{ &grid };
+		bounds.Build(agentSize, 1 + trial % 4);
+
+		Bounds loaded{ &grid };
+		++result.nrOfChecks;
+		if (!bounds.SaveToFile(filePath) || !loaded.LoadFromFile(filePath) || loaded.GetAgentSize() != agentSize)
+			++result.nrOfFailures;
+
+		const View view{ &grid, agentSize };
+		AStar<View> pathfinder{ &view, HeuristicFunctions::Octile };
+		AStar<View> loadedPathfinder{ &view, HeuristicFunctions::Octile };
+		pathfinder.SetGoalBounding(&bounds);
+		if (loaded.IsBuilt())
+			loadedPathfinder.SetGoalBounding(&loaded);
+
+		for (int query = 0; query < 40; ++query)
+		{
+			const int startIdx = randomInt(grid.GetNrOfNodes());
+			const int goalIdx = randomInt(grid.GetNrOfNodes());
+			if (startIdx == goalIdx || !grid.CanFitAgent(startIdx, agentSize) || !grid.CanFitAgent(goalIdx, agentSize))
+				continue;
+
+			// Pruning never removes every cheapest path
+			const float referenceCost = GetReferenceCost(grid, startIdx, goalIdx, agentSize);
+			const float cost = GetPathCost(grid, pathfinder.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx)));
+			const float loadedCost = GetPathCost(grid, loadedPathfinder.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx)));
+
+			++result.nrOfChecks;
+			if (abs(cost - referenceCost) > 1e-3f || abs(loadedCost - referenceCost) > 1e-3f)
+				++result.nrOfFailures;
+		}
+	}
+
+	// Damaged copies of a valid file
+	Grid grid{ 12, 12, 1, false, true };
+	RandomizeTerrain(grid, 15, 20);
+	Bounds bounds{ &grid };
+	bounds.Build();
+	bounds.SaveToFile(filePath);
+	std::ifstream file{ filePath, std::ios::binary };
+	const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	file.close();
+
+	auto getHeader = [](std::string& damagedBytes) { return reinterpret_cast<GoalBoundingHeader*>(&damagedBytes[0]); };
+	const std::vector<std::function<void(std::string&)>> damages
+	{
+		[](std::string& damagedBytes) { damagedBytes.resize(damagedBytes.size() - 1); },
+		[getHeader](std::string& damagedBytes) { ++getHeader(damagedBytes)->magic; },
+		[getHeader](std::string& damagedBytes) { ++getHeader(damagedBytes)->rows; },
+		[getHeader](std::string& damagedBytes) { getHeader(damagedBytes)->flags = GridFlag_TiledLayout; }
+	};
+	for (const auto& damage : damages)
+	{
+		std::string damagedBytes = bytes;
+		damage(damagedBytes);
+		std::ofstream{ filePath, std::ios::binary }.write(damagedBytes.data(), damagedBytes.size());
+
+		Bounds target{ &grid };
+		++result.nrOfChecks;
+		if (target.LoadFromFile(filePath) || target.IsBuilt())
+			++result.nrOfFailures;
+	}
+
+	std::remove(filePath.c_str());
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestFixedPointAStar() const
+{
+	TestResult result{ "Fixed point AStar" };
+	const Heuristic heuristics[] = { HeuristicFunctions::Chebyshev, HeuristicFunctions::Octile, HeuristicFunctions::Euclidean };
+
+	srand(36);
+	for (int trial = 0; trial < 30; ++trial)
+	{
+		// Every third grid only connects straight, all costs are multiples of 0.5
+		const int columns = 5 + randomInt(30);
+		const int rows = 5 + randomInt(30);
+		Grid grid{ columns, rows, 1, false, trial % 3 != 0, 1.f, 1.5f };
+		RandomizeTerrain(grid, 20, 20);
+
+		const IGraphView<GridTerrainNode, GraphConnection> view{ &grid };
+		for (Heuristic heuristic : heuristics)
+		{
+			AStar<IGraphView<GridTerrainNode, GraphConnection>> pathfinder{ &view, heuristic };
+			for (int query = 0; query < 20; ++query)
+			{
+				const int startIdx = randomInt(grid.GetNrOfNodes());
+				const int goalIdx = randomInt(grid.GetNrOfNodes());
+				if (startIdx == goalIdx || !grid.IsWalkable(startIdx) || !grid.IsWalkable(goalIdx))
+					continue;
+
+				// Both cost types find a path exactly when one exists, and it is a cheapest one
+				const float referenceCost = GetReferenceCost(grid, startIdx, goalIdx);
+				const float floatCost = GetPathCost(grid, pathfinder.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx)));
+				const float fixedPointCost = GetPathCost(grid, pathfinder.FindPath<uint32_t>(grid.GetNode(startIdx), grid.GetNode(goalIdx)));
+
+				++result.nrOfChecks;
+				if (abs(floatCost - referenceCost) > 1e-3f || abs(fixedPointCost - referenceCost) > 1e-3f)
+					++result.nrOfFailures;
+			}
+		}
+	}
+
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::TestPathRepair() const
+{
+	using Repair = PathRepair<GridTerrainNode, GraphConnection>;
+	TestResult result{ "Path repair" };
+
+	srand(46);
+	for (int trial = 0; trial < 200; ++trial)
+	{
+		const int columns = 20 + randomInt(40);
+		const int rows = 20 + randomInt(40);
+		Grid grid{ columns, rows, 1, false, true };
+		RandomizeTerrain(grid, 10, 15);
+
+		// Every fifth trial is for a bigger agent
+		const int agentSize = trial % 5 == 4 ? 2 : 1;
+		const int startIdx = randomInt(grid.GetNrOfNodes());
+		const int goalIdx = randomInt(grid.GetNrOfNodes());
+		if (!grid.CanFitAgent(startIdx, agentSize) || !grid.CanFitAgent(goalIdx, agentSize))
+			continue;
+
+		const IGraphView<GridTerrainNode, GraphConnection> view{ &grid, agentSize };
+		AStar<IGraphView<GridTerrainNode, GraphConnection>> pathfinder{ &view, HeuristicFunctions::Octile };
+		std::vector<GridTerrainNode*> path = pathfinder.FindPath(grid.GetNode(startIdx), grid.GetNode(goalIdx));
+		if (path.size() < 4)
+			continue;
+
+		// 1. Drop a blob of Water on a waypoint past the agent's, the agent's own cell and the goal stay free
+		const size_t currentWaypoint = randomInt(int(path.size()) / 2);
+		const size_t blockedWaypoint = currentWaypoint + 1 + randomInt(int(path.size() - currentWaypoint - 1));
+		const int agentIdx = path[currentWaypoint]->GetIndex();
+
+		int blockedCol, blockedRow;
+		grid.GetColRow(path[blockedWaypoint]->GetIndex(), blockedCol, blockedRow);
+		const int radius = randomInt(3);
+		for (int row = blockedRow - radius; row <= blockedRow + radius; ++row)
+		{
+			for (int col = blockedCol - radius; col <= blockedCol + radius; ++col)
+			{
+				if (!grid.IsWithinBounds(col, row))
+					continue;
+
+				const int idx = grid.GetIndex(col, row);
+				if (idx != agentIdx && idx != goalIdx)
+					grid.SetTerrainType(idx, TerrainType::Water);
+			}
+		}
+		grid.RebuildConnections();
+
+		// 2. Repair, with a local budget small enough on every other trial to force replans
+		const std::vector<GridTerrainNode*> originalPath = path;
+		Repair repair{ &grid, HeuristicFunctions::Octile, trial % 2 == 0 ? 512 : 4 };
+		const Repair::RepairResult repairResult = repair.Repair(path, currentWaypoint, agentSize);
+
+		++result.nrOfChecks;
+		if (repairResult == Repair::RepairResult::Failed)
+		{
+			if (grid.CanFitAgent(agentIdx, agentSize) && GetReferenceCost(grid, agentIdx, goalIdx, agentSize) >= 0.f)
+				++result.nrOfFailures;
+			continue;
+		}
+
+		const bool isPrefixKept = path.size() > currentWaypoint && std::equal(originalPath.begin(), originalPath.begin() + currentWaypoint + 1, path.begin());
+		if (!isPrefixKept || path.back()->GetIndex() != goalIdx || !IsPathWalkable(grid, path, currentWaypoint, agentSize))
+			++result.nrOfFailures;
+	}
+
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::StressEpochManager() const
+{
+	TestResult result{ "EpochManager stress" };
+	const int nrOfReaders = 3;
+	const int nrOfRetires = 2000;
+
+	// Objects are only marked as deleted, they stay allocated so a reader can still look at one that was deleted too early
+	struct Tracked
+	{
+		std::atomic<int> nrOfDeletes{ 0 };
+	};
+	std::vector<std::unique_ptr<Tracked>> objects{};
+	objects.reserve(nrOfRetires + 1);
+	objects.push_back(std::make_unique<Tracked>());
+
+	EpochManager epochs{};
+	std::atomic<Tracked*> pCurrent{ objects.back().get() };
+	std::atomic<bool> isStopped{ false };
+	std::atomic<int> nrOfChecks{ 0 };
+	std::atomic<int> nrOfFailures{ 0 };
+
+	// 1. Readers hold the current object for a while and check it stays alive
+	auto read = [&]()
+	{
+		while (!isStopped)
+		{
+			EpochManager::ReadGuard guard = epochs.Pin();
+			const Tracked* pObject = pCurrent.load();
+			for (int i = 0; i < 64; ++i)
+			{
+				if (pObject->nrOfDeletes.load() != 0)
+				{
+					++nrOfFailures;
+					break;
+				}
+				std::this_thread::yield();
+			}
+			++nrOfChecks;
+		}
+	};
+	std::vector<std::thread> readers{};
+	for (int i = 0; i < nrOfReaders; ++i)
+		readers.emplace_back(read);
+
+	// 2. The writer replaces the object and retires the old one
+	for (int i = 0; i < nrOfRetires; ++i)
+	{
+		objects.push_back(std::make_unique<Tracked>());
+		Tracked* pPrevious = pCurrent.exchange(objects.back().get());
+		epochs.Retire([pPrevious]() { ++pPrevious->nrOfDeletes; });
+		if (i % 16 == 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	isStopped = true;
+	for (std::thread& reader : readers)
+		reader.join();
+
+	// 3. Without readers everything retired is reclaimed, once
+	epochs.Reclaim();
+	result.nrOfChecks = nrOfChecks + 1;
+	result.nrOfFailures = nrOfFailures;
+	const bool isAllDeletedOnce = epochs.GetNrOfRetired() == 0
+		&& std::all_of(objects.begin(), objects.end() - 1, [](const std::unique_ptr<Tracked>& pObject) { return pObject->nrOfDeletes == 1; })
+		&& objects.back()->nrOfDeletes == 0;
+	if (!isAllDeletedOnce)
+		++result.nrOfFailures;
+
+	return result;
+}
+
+App_GraphTests::TestResult App_GraphTests::StressGraphSnapshots() const
+{
+	TestResult result{ "Graph snapshot stress" };
+	const int nrOfReaders = 3;
+	const int nrOfEdits = 300;
+	const int size = 70; // the last chunk row and column are cut off
+
+	srand(47);
+	Grid grid{ size, size, 1, false, true };
+	RandomizeTerrain(grid, 10, 20);
+
+	// Fingerprint of every cell's terrain, one per version
+	auto getFingerprint = [size](auto getTerrainType)
+	{
+		uint32_t fingerprint = 0;
+		for (int row = 0; row < size; ++row)
+		{
+			for (int col = 0; col < size; ++col)
+				fingerprint = fingerprint * 31 + uint32_t(getTerrainType(col, row));
+		}
+		return fingerprint;
+	};
+	auto getSnapshotFingerprint = [&getFingerprint](const GridSnapshot& snapshot)
+	{
+		return getFingerprint([&snapshot](int col, int row) { return snapshot.GetTerrainType(col, row); });
+	};
+
+	// 1. Build every version up front from the grid's terrain, so readers know what each one has to hold
+	// An edit changes one chunk, the snapshot after it shares all the others
+	std::vector<std::unique_ptr<const GridSnapshot>> snapshots{};
+	std::vector<uint32_t> fingerprints{ 0 }; // versions start at 1
+	int nrOfSharingFailures = 0;
+	for (int i = 0; i <= nrOfEdits; ++i)
+	{
+		if (i > 0)
+			grid.SetTerrainType(randomInt(grid.GetNrOfNodes()), randomInt(2) == 0 ? TerrainType::Water : TerrainType::Ground);
+
+		snapshots.push_back(GridSnapshot::FromGrid(grid, i > 0 ? snapshots.back().get() : nullptr));
+		fingerprints.push_back(getFingerprint([&grid](int col, int row) { return grid.GetTerrainType(grid.GetIndex(col, row)); }));
+		if (i > 0 && snapshots[i]->GetNrOfSharedChunks(*snapshots[i - 1]) < snapshots[i]->GetNrOfChunks() - 1)
+			++nrOfSharingFailures;
+	}
+
+	VersionedGraph<GridSnapshot> versions{};
+	std::atomic<bool> isStopped{ false };
+	std::atomic<int> nrOfChecks{ 0 };
+	std::atomic<int> nrOfFailures{ 0 };
+
+	// 2. Readers search the version they hold and check it before and after
+	auto read = [&](int seed)
+	{
+		int lastVersion = 0;
+		uint32_t random = uint32_t(seed);
+		auto nextCell = [&random, size]() { random = random * 1664525u + 1013904223u; return int((random >> 8) % uint32_t(size * size)); };
+
+		while (!isStopped)
+		{
+			const VersionedGraph<GridSnapshot>::Reader reader = versions.Read();
+			if (!reader)
+				continue;
+
+			const int version = reader.GetVersion();
+			bool isConsistent = version >= lastVersion && getSnapshotFingerprint(*reader) == fingerprints[version];
+			lastVersion = version;
+
+			for (int idx : FindPathAStar(*reader, nextCell(), nextCell(), HeuristicFunctions::Octile))
+			{
+				int col, row;
+				reader->GetColRow(idx, col, row);
+				isConsistent = isConsistent && reader->IsWalkable(col, row);
+			}
+
+			isConsistent = isConsistent && getSnapshotFingerprint(*reader) == fingerprints[version];
+			++nrOfChecks;
+			if (!isConsistent)
+				++nrOfFailures;
+		}
+	};
+	std::vector<std::thread> readers{};
+	for (int i = 0; i < nrOfReaders; ++i)
+		readers.emplace_back(read, i + 1);
+
+	// 3. The writer publishes the versions in order
+	for (std::unique_ptr<const GridSnapshot>& pSnapshot : snapshots)
+	{
+		versions.Publish(std::move(pSnapshot));
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+
+	isStopped = true;
+	for (std::thread& reader : readers)
+		reader.join();
+
+	// 4. Without readers the next publish reclaims every replaced version
+	versions.Publish(GridSnapshot::FromGrid(grid, versions.GetLatest()));
+	result.nrOfChecks = nrOfChecks + nrOfEdits + 1;
+	result.nrOfFailures = nrOfFailures + nrOfSharingFailures;
+	if (versions.GetNrOfRetiredVersions() != 0 || versions.GetLatestVersion() != nrOfEdits + 2)
+		++result.nrOfFailures;
+
+	return result;
+}
+
+void App_GraphTests::RandomizeTerrain(Grid& grid, int waterPercentage, int mudPercentage)
+{
+	for (int idx = 0; idx < grid.GetNrOfNodes(); ++idx)
+	{
+		const int roll = randomInt(100);
+		if (roll < waterPercentage)
+			grid.SetTerrainType(idx, TerrainType::Water);
+		else if (roll < waterPercentage + mudPercentage)
+			grid.SetTerrainType(idx, TerrainType::Mud);
+		else
+			grid.SetTerrainType(idx, TerrainType::Ground);
+	}
+	grid.RebuildConnections();
+}
+
+float App_GraphTests::GetReferenceCost(const Grid& grid, int startIdx, int goalIdx, int agentSize)
+{
+	// Plain Dijkstra, outdated queue entries are skipped instead of updated
+	using QueueEntry = std::pair<float, int>;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> openList{};
+	std::vector<float> costs(grid.GetNrOfNodes(), std::numeric_limits<float>::max());
+	costs[startIdx] = 0.f;
+	openList.push({ 0.f, startIdx });
+
+	while (!openList.empty())
+	{
+		const QueueEntry current = openList.top();
+		openList.pop();
+
+		if (current.first > costs[current.second])
+			continue;
+		if (current.second == goalIdx)
+			return current.first;
+
+		for (const auto& pConnection : grid.GetNodeConnections(current.second))
+		{
+			const int toIdx = pConnection->GetTo();
+			const float cost = current.first + pConnection->GetCost();
+			if (grid.CanFitAgent(toIdx, agentSize) && cost < costs[toIdx])
+			{
+				costs[toIdx] = cost;
+				openList.push({ cost, toIdx });
+			}
+		}
+	}
+
+	return -1.f;
+}
+
+float App_GraphTests::GetPathCost(const Grid& grid, const std::vector<GridTerrainNode*>& path)
+{
+	if (path.empty())
+		return -1.f;
+
+	float cost = 0.f;
+	for (size_t i = 1; i < path.size(); ++i)
+	{
+		const GraphConnection* pConnection = grid.GetConnection(path[i - 1]->GetIndex(), path[i]->GetIndex());
+		if (pConnection == nullptr)
+			return -2.f;
+		cost += pConnection->GetCost();
+	}
+	return cost;
+}
+
+bool App_GraphTests::AreGridsEqual(const Grid& grid, const Grid& other)
+{
+	if (grid.GetColumns() != other.GetColumns() || grid.GetRows() != other.GetRows() || grid.GetLayout() != other.GetLayout()
+		|| grid.IsConnectedDiagonally() != other.IsConnectedDiagonally() || grid.IsDirectionalGraph() != other.IsDirectionalGraph()
+		|| grid.GetDefaultCostStraight() != other.GetDefaultCostStraight() || grid.GetDefaultCostDiagonal() != other.GetDefaultCostDiagonal()
+		|| grid.GetTerrainData() != other.GetTerrainData() || grid.GetNrOfNodes() != other.GetNrOfNodes())
+		return false;
+
+	auto getConnections = [](const Grid& g, int idx)
+	{
+		std::vector<std::pair<int, float>> connections{};
+		for (const auto& pConnection : g.GetConnections(idx))
+			connections.push_back({ pConnection->GetTo(), pConnection->GetCost() });
+		std::sort(connections.begin(), connections.end());
+		return connections;
+	};
+
+	for (int idx = 0; idx < grid.GetNrOfNodes(); ++idx)
+	{
+		if (grid.GetClearance(idx) != other.GetClearance(idx) || getConnections(grid, idx) != getConnections(other, idx))
+			return false;
+	}
+	return true;
+}
+
+bool App_GraphTests::IsPathWalkable(const Grid& grid, const std::vector<GridTerrainNode*>& path, size_t firstWaypoint, int agentSize)
+{
+	for (size_t i = firstWaypoint + 1; i < path.size(); ++i)
+	{
+		if (!grid.CanFitAgent(path[i]->GetIndex(), agentSize) || grid.GetConnection(path[i - 1]->GetIndex(), path[i]->GetIndex()) == nullptr)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,90 @@
+#ifndef GRAPH_TESTS_APPLICATION_H
+#define GRAPH_TESTS_APPLICATION_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include "framework/EliteInterfaces/EIApp.h"
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+
+
+//-----------------------------------------------------------------
+// Application
+//-----------------------------------------------------------------
+// Randomized checks of the graph algorithms against simple reference implementations
+// Every test runs on Start (and on "Run tests"), prints its result and lists it in the panel. Seeds are fixed, so a
+// failure can be reproduced by running the same test again.
+class App_GraphTests final : public IApp
+{
+public:
+	//Constructor & Destructor
+	App_GraphTests() = default;
+	virtual ~App_GraphTests() = default;
+
+	//App Functions
+	void Start() override;
+	void Update(float deltaTime) override;
+	void Render(float deltaTime) const override;
+
+private:
+	using Grid = Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>;
+
+	struct TestResult
+	{
+		std::string name;
+		int nrOfChecks = 0;
+		int nrOfFailures = 0;
+	};
+
+	//Datamembers
+	std::vector<TestResult> m_TestResults{};
+
+	//Functions
+	void RunTests();
+	void UpdateImGui();
+
+	// GridGraph save -> load on random grids with hand edited connections gives the same grid, also when the first use of
+	// the loaded grid comes from several threads at once, and damaged files are refused without touching the grid
+	TestResult TestGridGraphFiles() const;
+	// NavGraph files with a triangle, line, node or connection index out of range are refused
+	TestResult TestNavGraphFiles() const;
+	// WeightedJPS paths on random Ground/Mud/Water grids, with and without diagonal connections, are walkable for the agent
+	// and cost the same as a reference Dijkstra
+	TestResult TestWeightedJPS() const;
+	// SubgoalGraph paths on random Ground/Water grids are walkable for the agent size it was built for and cost the same as
+	// a reference Dijkstra, also when several threads query it at once
+	TestResult TestSubgoalGraph() const;
+	// CompressedPathDatabase paths cost the same as a reference Dijkstra on random grids, also after save -> load, and files
+	// with a move that isn't a direction, a move off the grid, runs out of order or another grid size are refused
+	TestResult TestCompressedPathDatabase() const;
+	// AStar with GoalBounding finds paths that cost the same as a reference Dijkstra for the agent size the bounds were built
+	// for, also with bounds that were saved and loaded, and files for another grid size or layout are refused
+	TestResult TestGoalBounding() const;
+	// Fixed point AStar (uint32_t costs) against float AStar and a reference Dijkstra on random grids and heuristics
+	TestResult TestFixedPointAStar() const;
+	// PathRepair after Water is dropped on a path: the repaired path is walkable for the agent, reaches the goal and keeps
+	// the waypoints up to the agent's, and a repair only fails when the goal can't be reached any more
+	TestResult TestPathRepair() const;
+	// Reader threads pin objects a writer keeps replacing and retiring: no object a pinned reader holds is deleted,
+	// and every retired object is deleted exactly once
+	TestResult StressEpochManager() const;
+	// Reader threads search the latest GridSnapshot while the writer edits and publishes: each snapshot a reader holds
+	// matches the grid's terrain of its version for as long as it is held, versions never go back, paths are walkable on
+	// it, and a snapshot after one edit shares every chunk but the edited one with the one before
+	TestResult StressGraphSnapshots() const;
+
+	// Random Water, Mud and Ground cells, connections rebuilt
+	static void RandomizeTerrain(Grid& grid, int waterPercentage, int mudPercentage);
+	// Cost of the cheapest path for an agent of agentSize, -1 if the goal can't be reached
+	static float GetReferenceCost(const Grid& grid, int startIdx, int goalIdx, int agentSize = 1);
+	// Sum of the connection costs along the path, -1 if it is empty and -2 if it uses a connection the grid doesn't have
+	static float GetPathCost(const Grid& grid, const std::vector<Elite::GridTerrainNode*>& path);
+	// Same size, settings, terrain, clearance and connections (target and cost, in any order)
+	static bool AreGridsEqual(const Grid& grid, const Grid& other);
+	// Every step from firstWaypoint on follows a connection onto a node the agent fits on
+	static bool IsPathWalkable(const Grid& grid, const std::vector<Elite::GridTerrainNode*>& path, size_t firstWaypoint, int agentSize);
+
+	//C++ make the class non-copyable
+	App_GraphTests(const App_GraphTests&) = delete;
+	App_GraphTests& operator=(const App_GraphTests&) = delete;
+};
+#endif